@@ -0,0 +1,143 @@
+#include "Batch_Queue.h"
+#include <algorithm>
+#include <future>
+#include "fmt/format.h"
+
+namespace beast = boost::beast;
+namespace http = beast::http;
+
+namespace {
+	// The routes are comma separated inside one query parameter, so their own
+	// query strings have to be escaped
+	std::string encode_route(const std::string& route)
+	{
+		std::string encoded;
+		encoded.reserve(route.size());
+		for (auto c : route) {
+			switch (c) {
+			case '?': encoded += "%3F"; break;
+			case '&': encoded += "%26"; break;
+			case '=': encoded += "%3D"; break;
+			case ',': encoded += "%2C"; break;
+			case '+': encoded += "%2B"; break;
+			case ' ': encoded += "%20"; break;
+			default: encoded += c; break;
+			}
+		}
+		return encoded;
+	}
+}
+
+Batch_Queue::Batch_Queue(Request_Engine& engine, const std::string& secrect, const char* children_key) :
+	engine_{ engine },
+	secrect_{ secrect },
+	children_key_{ children_key }
+{
+}
+
+void Batch_Queue::enqueue(std::string route, result_handler handler)
+{
+	queue_.push_back({ std::move(route), std::move(handler) });
+}
+
+std::string Batch_Queue::make_target(std::vector<Entry>::const_iterator first, std::vector<Entry>::const_iterator last) const
+{
+	std::string urls;
+	for (auto it = first; it != last; ++it) {
+		if (!urls.empty()) {
+			urls += ',';
+		}
+		urls += encode_route(it->route);
+	}
+	return fmt::format("/1/batch?urls={}&{}", urls, secrect_);
+}
+
+void Batch_Queue::flush(bool speculative)
+{
+	if (queue_.empty()) {
+		return;
+	}
+
+	auto entries = std::make_shared<std::vector<Entry>>(std::move(queue_));
+	queue_.clear();
+
+	std::vector<std::string> targets;
+	for (std::size_t offset = 0; offset < entries->size(); offset += max_routes) {
+		auto first = entries->cbegin() + offset;
+		auto last = entries->cbegin() + std::min(offset + max_routes, entries->size());
+		targets.push_back(make_target(first, last));
+	}
+
+	// Hands the routes of one batch their part of its response
+	auto deliver = [engine = &engine_, children_key = children_key_, entries](std::size_t batch, beast::error_code ec, Request_Engine::response_type& response) {
+		auto const offset = batch * max_routes;
+		auto const count = std::min(max_routes, entries->size() - offset);
+
+		std::optional<std::vector<Result>> routes;
+		if (!ec && response.result() == http::status::ok) {
+			auto const start = std::chrono::steady_clock::now();
+			routes = Record_Decoder::decode_batch(response.body(), children_key);
+			engine->metrics().record("batch.parse", start);
+		}
+		// Without a decodable body the batch call itself failed
+		auto const status = ec || (response.result() == http::status::ok && !routes) ? 0u : response.result_int();
+		engine->release(std::move(response));
+
+		for (std::size_t i = 0; i < count; ++i) {
+			auto& entry = (*entries)[offset + i];
+			if (routes && i < routes->size()) {
+				entry.handler(std::move((*routes)[i]));
+			}
+			else {
+				// Report the status of the whole batch for every route
+				entry.handler({ status, {} });
+			}
+		}
+	};
+
+	if (speculative) {
+		for (std::size_t batch = 0; batch < targets.size(); ++batch) {
+			engine_.async_prefetch(std::move(targets[batch]), {}, [deliver, batch](beast::error_code ec, Request_Engine::response_type res) {
+				deliver(batch, ec, res);
+			});
+		}
+		return;
+	}
+
+	// Independent batches go out in parallel, or pipelined if enabled
+	engine_.async_get_all(std::move(targets), [deliver](std::vector<Request_Engine::Result> results) {
+		for (std::size_t batch = 0; batch < results.size(); ++batch) {
+			deliver(batch, results[batch].ec, results[batch].response);
+		}
+	});
+}
+
+std::vector<Batch_Queue::Result> Batch_Queue::fetch(const std::vector<std::string>& routes)
+{
+	struct State {
+		std::vector<Result> results;
+		std::size_t remaining;
+		std::promise<void> done;
+	};
+
+	if (routes.empty()) {
+		return {};
+	}
+
+	State state{ std::vector<Result>(routes.size()), routes.size(), {} };
+	auto future = state.done.get_future();
+
+	for (std::size_t i = 0; i < routes.size(); ++i) {
+		// All handlers run on the io thread, one after another
+		enqueue(routes[i], [&state, i](Result result) {
+			state.results[i] = std::move(result);
+			if (--state.remaining == 0) {
+				state.done.set_value();
+			}
+		});
+	}
+	flush();
+
+	future.get();
+	return std::move(state.results);
+}
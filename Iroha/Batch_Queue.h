@@ -0,0 +1,46 @@
+#pragma once
+#include "Request_Engine.h"
+#include "Record_Decoder.h"
+
+// Coalesces GET requests into calls to Trello's /1/batch endpoint.
+// Routes are queued with enqueue() and sent by flush(), at most max_routes per call.
+// The routes must return boards, lists or cards, each batch is decoded straight into records.
+// enqueue() and flush() must be called from the same thread, handlers run on the io thread.
+class Batch_Queue {
+public:
+	// Trello rejects batches with more routes than this
+	static constexpr std::size_t max_routes = 10;
+
+	// Outcome of one route inside a batch. Status 0 means the batch call itself failed.
+	using Result = Record_Decoder::Route;
+	using result_handler = std::function<void(Result)>;
+
+private:
+	struct Entry {
+		std::string route;
+		result_handler handler;
+	};
+
+	Request_Engine& engine_;
+	std::string const& secrect_;
+	const char* children_key_;
+	std::vector<Entry> queue_;
+
+private:
+	std::string make_target(std::vector<Entry>::const_iterator first, std::vector<Entry>::const_iterator last) const;
+
+public:
+	// The secret is "key=...&token=..." and must outlive the queue.
+	// children_key names a nested array that becomes the children, see Record_Decoder::decode().
+	Batch_Queue(Request_Engine& engine, const std::string& secrect, const char* children_key = nullptr);
+
+	// Queue a route such as "/boards/{id}/lists?fields=name", without the "/1" prefix and credentials
+	void enqueue(std::string route, result_handler handler);
+
+	// Send everything queued so far. Speculative batches go out at low priority and are dropped,
+	// without calling their handlers, if Request_Engine::cancel_background() runs before they are sent.
+	void flush(bool speculative = false);
+
+	// Fetch the routes and wait for all of them. Must not be called from the io thread.
+	std::vector<Result> fetch(const std::vector<std::string>& routes);
+};
@@ -0,0 +1,36 @@
+#include "Body_Pool.h"
+#include <algorithm>
+
+std::string Body_Pool::acquire()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	if (spare_.empty()) {
+		return {};
+	}
+
+	auto body = std::move(spare_.back());
+	spare_.pop_back();
+	spare_bytes_ -= body.capacity();
+	return body;
+}
+
+void Body_Pool::release(std::string body)
+{
+	if (body.capacity() == 0 || body.capacity() > max_capacity) {
+		return;
+	}
+	body.clear();
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	auto position = std::lower_bound(spare_.begin(), spare_.end(), body.capacity(), [](const std::string& spare, std::size_t capacity) {
+		return spare.capacity() < capacity;
+	});
+	spare_bytes_ += body.capacity();
+	spare_.insert(position, std::move(body));
+
+	// Drop the smallest ones first
+	while (spare_.size() > max_spare || spare_bytes_ > max_spare_bytes) {
+		spare_bytes_ -= spare_.front().capacity();
+		spare_.erase(spare_.begin());
+	}
+}
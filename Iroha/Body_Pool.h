@@ -0,0 +1,26 @@
+#pragma once
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Response body storage kept for reuse. Connections read every response into a string taken
+// from the pool, and callers hand the string back once the body is decoded, so repeated and
+// bulk fetches stop allocating once the pool is warm. Used from the io thread and the main thread.
+class Body_Pool {
+public:
+	static constexpr std::size_t max_spare = 16;
+	// Idle storage kept in total, the rest goes back to the allocator
+	static constexpr std::size_t max_spare_bytes = 8 * 1024 * 1024;
+	// Strings grown beyond this, like the body of a very large board, are freed instead of being kept around
+	static constexpr std::size_t max_capacity = 4 * 1024 * 1024;
+
+private:
+	std::mutex mutex_;
+	std::vector<std::string> spare_; // Largest capacity at the back
+	std::size_t spare_bytes_{ 0 }; // Capacity of the spare strings
+
+public:
+	// An empty string, with the largest capacity available
+	std::string acquire();
+	void release(std::string body);
+};
@@ -0,0 +1,221 @@
+#include "Connection.h"
+
+namespace beast = boost::beast;
+namespace http = beast::http;
+namespace net = boost::asio;
+namespace ssl = boost::asio::ssl;
+using tcp = boost::asio::ip::tcp;
+
+namespace {
+	// Upper bound for a single connect or request before the stream gives up
+	constexpr auto operation_timeout = std::chrono::seconds(30);
+	// The server may never answer close_notify, do not wait for it too long
+	constexpr auto shutdown_timeout = std::chrono::seconds(5);
+}
+
+Connection::Connection(net::io_context& ioc, ssl::context& ctx, Body_Pool& bodies, Metrics& metrics, std::string host) :
+	stream_{ ioc, ctx },
+	bodies_{ bodies },
+	metrics_{ metrics },
+	host_{ std::move(host) }
+{
+}
+
+void Connection::async_connect(const tcp::resolver::results_type& endpoints, const session_type& session, connect_handler handler)
+{
+	connect_handler_ = std::move(handler);
+
+	// Set SNI Hostname (many hosts need this to handshake successfully)
+	if (!SSL_set_tlsext_host_name(stream_.native_handle(), host_.c_str()))
+	{
+		beast::error_code ec{ static_cast<int>(::ERR_get_error()), net::error::get_ssl_category() };
+		return on_handshake(ec);
+	}
+
+	// Offer the previous session so the server can skip the full handshake
+	if (session) {
+		SSL_set_session(stream_.native_handle(), session.get());
+	}
+
+	// Make the connection on the IP address we got from the lookup
+	phase_start_ = std::chrono::steady_clock::now();
+	beast::get_lowest_layer(stream_).expires_after(operation_timeout);
+	beast::get_lowest_layer(stream_).async_connect(endpoints, beast::bind_front_handler(&Connection::on_connect, shared_from_this()));
+}
+
+void Connection::on_connect(beast::error_code ec, tcp::endpoint)
+{
+	if (ec) {
+		return on_handshake(ec);
+	}
+	metrics_.record("connect", phase_start_);
+	phase_start_ = std::chrono::steady_clock::now();
+
+	// Perform the SSL handshake
+	stream_.async_handshake(ssl::stream_base::client, beast::bind_front_handler(&Connection::on_handshake, shared_from_this()));
+}
+
+void Connection::on_handshake(beast::error_code ec)
+{
+	beast::get_lowest_layer(stream_).expires_never();
+	usable_ = !ec;
+	last_used_ = std::chrono::steady_clock::now();
+	if (!ec) {
+		metrics_.record(SSL_session_reused(stream_.native_handle()) ? "tls.resumed" : "tls", phase_start_);
+	}
+
+	auto handler = std::move(connect_handler_);
+	connect_handler_ = nullptr;
+	if (handler) {
+		handler(ec);
+	}
+}
+
+void Connection::async_pipeline(std::vector<request_type> requests, pipeline_handler handler)
+{
+	requests_ = std::move(requests);
+	responses_.clear();
+	responses_.reserve(requests_.size());
+	written_ = 0;
+	request_sent_ = false;
+	pipeline_handler_ = std::move(handler);
+	phase_start_ = std::chrono::steady_clock::now();
+
+	write_next();
+}
+
+void Connection::write_next()
+{
+	// Send the HTTP request to the remote host
+	beast::get_lowest_layer(stream_).expires_after(operation_timeout);
+	http::async_write(stream_, requests_[written_], beast::bind_front_handler(&Connection::on_write, shared_from_this()));
+}
+
+void Connection::on_write(beast::error_code ec, std::size_t)
+{
+	if (ec) {
+		return finish(ec);
+	}
+
+	if (++written_ < requests_.size()) {
+		return write_next();
+	}
+	request_sent_ = true;
+	// A pipeline is written as one, it is not the write time of any one endpoint
+	if (requests_.size() > 1) {
+		metrics_.record("pipeline.write", phase_start_);
+	}
+	else {
+		metrics_.record(Metrics::endpoint(requests_.front().method(), requests_.front().target()) + ".write", phase_start_);
+	}
+	phase_start_ = std::chrono::steady_clock::now();
+
+	read_next();
+}
+
+void Connection::read_next()
+{
+	// Receive the HTTP response. The flat buffer is reused across responses,
+	// the body goes into recycled storage.
+	parser_.emplace(std::piecewise_construct, std::make_tuple(bodies_.acquire()));
+	// Beast caps response bodies at 8 MB by default, large boards exceed that
+	parser_->body_limit(boost::none);
+	beast::get_lowest_layer(stream_).expires_after(operation_timeout);
+	http::async_read_header(stream_, buffer_, *parser_, beast::bind_front_handler(&Connection::on_header, shared_from_this()));
+}
+
+void Connection::on_header(beast::error_code ec, std::size_t)
+{
+	if (ec) {
+		return finish(ec);
+	}
+
+	// Until the header arrives the server is working, or busy with the previous response of a pipeline
+	const auto& request = requests_[responses_.size()];
+	metrics_.record(Metrics::endpoint(request.method(), request.target()) + ".server", phase_start_);
+	phase_start_ = std::chrono::steady_clock::now();
+
+	http::async_read(stream_, buffer_, *parser_, beast::bind_front_handler(&Connection::on_read, shared_from_this()));
+}
+
+void Connection::on_read(beast::error_code ec, std::size_t)
+{
+	if (ec) {
+		return finish(ec);
+	}
+
+	const auto& request = requests_[responses_.size()];
+	metrics_.record(Metrics::endpoint(request.method(), request.target()) + ".body", phase_start_);
+	phase_start_ = std::chrono::steady_clock::now();
+
+	++requests_completed_;
+	auto const keep_alive = parser_->keep_alive();
+	responses_.push_back(parser_->release());
+	parser_.reset();
+
+	if (responses_.size() == requests_.size()) {
+		return finish({});
+	}
+
+	if (!keep_alive) {
+		// The server will not answer the rest of the pipeline
+		return finish(http::error::end_of_stream);
+	}
+
+	read_next();
+}
+
+void Connection::finish(beast::error_code ec)
+{
+	beast::get_lowest_layer(stream_).expires_never();
+	usable_ = !ec && !responses_.empty() && responses_.back().keep_alive();
+	last_used_ = std::chrono::steady_clock::now();
+	requests_.clear();
+
+	auto handler = std::move(pipeline_handler_);
+	pipeline_handler_ = nullptr;
+	handler(ec, std::move(responses_));
+}
+
+bool Connection::is_usable() const
+{
+	return usable_ && beast::get_lowest_layer(stream_).socket().is_open();
+}
+
+std::chrono::steady_clock::time_point Connection::last_used() const
+{
+	return last_used_;
+}
+
+std::size_t Connection::requests_completed() const
+{
+	return requests_completed_;
+}
+
+bool Connection::request_sent() const
+{
+	return request_sent_;
+}
+
+Connection::session_type Connection::session()
+{
+	// With TLS 1.3 the ticket arrives after the handshake, so ask after a response was read
+	auto session = SSL_get1_session(stream_.native_handle());
+	if (session == nullptr) {
+		return nullptr;
+	}
+	return session_type(session, SSL_SESSION_free);
+}
+
+void Connection::close()
+{
+	usable_ = false;
+	if (!beast::get_lowest_layer(stream_).socket().is_open()) {
+		return;
+	}
+
+	beast::get_lowest_layer(stream_).expires_after(shutdown_timeout);
+	stream_.async_shutdown([self = shared_from_this()](beast::error_code) {
+		beast::get_lowest_layer(self->stream_).close();
+	});
+}
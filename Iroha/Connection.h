@@ -0,0 +1,79 @@
+#pragma once
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/beast/ssl.hpp>
+#include "Body_Pool.h"
+#include "Metrics.h"
+#include <optional>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// A single keep-alive TLS connection to the Trello API.
+// A Connection is never reopened, a dropped connection is replaced by a new one
+// which resumes the TLS session of its predecessor.
+// Every member function must be called from the thread running the io_context.
+class Connection : public std::enable_shared_from_this<Connection> {
+public:
+	using request_type = boost::beast::http::request<boost::beast::http::empty_body>;
+	using response_type = boost::beast::http::response<boost::beast::http::string_body>;
+	using connect_handler = std::function<void(boost::beast::error_code)>;
+	// Receives the responses read so far, in request order. On error there may be fewer responses than requests.
+	using pipeline_handler = std::function<void(boost::beast::error_code, std::vector<response_type>)>;
+	using session_type = std::shared_ptr<SSL_SESSION>;
+
+private:
+	boost::beast::ssl_stream<boost::beast::tcp_stream> stream_;
+	boost::beast::flat_buffer buffer_;
+	Body_Pool& bodies_;
+	Metrics& metrics_;
+	std::string const host_;
+	std::vector<request_type> requests_;
+	std::vector<response_type> responses_;
+	std::size_t written_{ 0 };
+	std::optional<boost::beast::http::response_parser<boost::beast::http::string_body>> parser_;
+	connect_handler connect_handler_;
+	pipeline_handler pipeline_handler_;
+	std::chrono::steady_clock::time_point last_used_{ std::chrono::steady_clock::now() };
+	std::chrono::steady_clock::time_point phase_start_; // Start of the connect, handshake, write or read in progress
+	bool usable_{ false }; // Handshaken and the server did not ask to close
+	bool request_sent_{ false }; // Every request of the current pipeline was fully written
+	std::size_t requests_completed_{ 0 };
+
+private:
+	void on_connect(boost::beast::error_code ec, boost::asio::ip::tcp::endpoint endpoint);
+	void on_handshake(boost::beast::error_code ec);
+	void write_next();
+	void on_write(boost::beast::error_code ec, std::size_t bytes_transferred);
+	void read_next();
+	void on_header(boost::beast::error_code ec, std::size_t bytes_transferred);
+	void on_read(boost::beast::error_code ec, std::size_t bytes_transferred);
+	void finish(boost::beast::error_code ec);
+
+public:
+	// Response bodies are read into strings taken from the body pool.
+	// Connect, handshake and per-request write, server and body times go to the metrics.
+	Connection(boost::asio::io_context& ioc, boost::asio::ssl::context& ctx, Body_Pool& bodies, Metrics& metrics, std::string host);
+
+	// Connect to one of the already resolved endpoints and perform the TLS handshake.
+	// If a previous session is given the handshake tries to resume it.
+	void async_connect(const boost::asio::ip::tcp::resolver::results_type& endpoints, const session_type& session, connect_handler handler);
+
+	// Write all requests back-to-back, then read their responses in order (HTTP/1.1 pipelining).
+	// A single request is a pipeline of one. Only one pipeline may be in flight at a time.
+	void async_pipeline(std::vector<request_type> requests, pipeline_handler handler);
+
+	// True if the connection can carry another request
+	bool is_usable() const;
+	std::chrono::steady_clock::time_point last_used() const;
+	std::size_t requests_completed() const;
+	bool request_sent() const;
+
+	// The current TLS session, to be handed to the next connection
+	session_type session();
+
+	// Gracefully close the stream in the background. Ignore all error.
+	void close();
+};
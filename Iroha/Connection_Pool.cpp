@@ -0,0 +1,202 @@
+#include "Connection_Pool.h"
+#include <algorithm>
+
+namespace beast = boost::beast;
+namespace net = boost::asio;
+namespace ssl = boost::asio::ssl;
+using tcp = boost::asio::ip::tcp;
+
+Connection_Pool::Connection_Pool(net::io_context& ioc, ssl::context& ctx, Body_Pool& bodies, Metrics& metrics, std::string host, unsigned short port,
+	std::size_t size, std::chrono::seconds idle_timeout) :
+	ioc_{ ioc },
+	ctx_{ ctx },
+	bodies_{ bodies },
+	metrics_{ metrics },
+	host_{ std::move(host) },
+	port_{ port },
+	size_{ std::max<std::size_t>(size, 1) },
+	idle_timeout_{ idle_timeout },
+	resolver_{ ioc },
+	eviction_timer_{ ioc }
+{
+}
+
+void Connection_Pool::async_warm_up(std::function<void(std::size_t)> handler)
+{
+	schedule_eviction();
+
+	auto remaining = std::make_shared<std::size_t>(size_ - open_);
+	auto opened = std::make_shared<std::size_t>(0);
+	if (*remaining == 0) {
+		return handler(open_);
+	}
+
+	for (auto i = *remaining; i > 0; --i) {
+		open_connection([this, remaining, opened, handler](beast::error_code ec, std::shared_ptr<Connection> connection) {
+			if (!ec) {
+				++*opened;
+				checkin(std::move(connection));
+			}
+			if (--*remaining == 0) {
+				handler(*opened);
+			}
+		});
+	}
+}
+
+void Connection_Pool::async_resolve(std::function<void(beast::error_code)> handler)
+{
+	if (!endpoints_.empty()) {
+		return handler({});
+	}
+
+	// Only one lookup at a time, everybody else waits for its result
+	resolve_waiters_.push_back(std::move(handler));
+	if (resolve_waiters_.size() > 1) {
+		return;
+	}
+
+	resolver_.async_resolve(host_, std::to_string(port_), [this, start = std::chrono::steady_clock::now()](beast::error_code ec, tcp::resolver::results_type results) {
+		if (!ec) {
+			endpoints_ = std::move(results);
+			metrics_.record("dns", start);
+		}
+		auto waiters = std::move(resolve_waiters_);
+		resolve_waiters_.clear();
+		for (auto& waiter : waiters) {
+			waiter(ec);
+		}
+	});
+}
+
+void Connection_Pool::open_connection(checkout_handler handler)
+{
+	++open_;
+	async_resolve([this, handler = std::move(handler)](beast::error_code ec) {
+		if (ec) {
+			--open_;
+			handler(ec, nullptr);
+			return serve_waiter();
+		}
+
+		auto connection = std::make_shared<Connection>(ioc_, ctx_, bodies_, metrics_, host_);
+		connection->async_connect(endpoints_, session_, [this, connection, handler](beast::error_code ec) {
+			if (ec) {
+				// The cached addresses may be outdated, look them up again next time
+				endpoints_ = {};
+				--open_;
+				handler(ec, nullptr);
+				return serve_waiter();
+			}
+			handler(ec, connection);
+		});
+	});
+}
+
+bool Connection_Pool::is_healthy(const Connection& connection) const
+{
+	// A connection that sat idle for too long has most likely been dropped by the server
+	return connection.is_usable() && std::chrono::steady_clock::now() - connection.last_used() < idle_timeout_;
+}
+
+void Connection_Pool::discard(const std::shared_ptr<Connection>& connection)
+{
+	connection->close();
+	--open_;
+}
+
+void Connection_Pool::async_checkout(checkout_handler handler)
+{
+	if (closed_) {
+		return handler(net::error::operation_aborted, nullptr);
+	}
+
+	while (!idle_.empty()) {
+		auto connection = std::move(idle_.back());
+		idle_.pop_back();
+
+		if (is_healthy(*connection)) {
+			return handler({}, std::move(connection));
+		}
+		discard(connection);
+	}
+
+	if (open_ < size_) {
+		return open_connection(std::move(handler));
+	}
+
+	waiters_.push_back(std::move(handler));
+}
+
+void Connection_Pool::checkin(std::shared_ptr<Connection> connection)
+{
+	if (closed_ || !is_healthy(*connection)) {
+		discard(connection);
+	}
+	else {
+		// Keep the newest session ticket for the next reconnect
+		if (auto session = connection->session()) {
+			session_ = std::move(session);
+		}
+		idle_.push_back(std::move(connection));
+	}
+
+	// Either a connection or a free slot is available now
+	serve_waiter();
+}
+
+void Connection_Pool::serve_waiter()
+{
+	// A failed attempt serves the next waiter in turn, so the queue always drains
+	if (!waiters_.empty() && !closed_) {
+		auto waiter = std::move(waiters_.front());
+		waiters_.pop_front();
+		async_checkout(std::move(waiter));
+	}
+}
+
+void Connection_Pool::schedule_eviction()
+{
+	eviction_timer_.expires_after(std::max(idle_timeout_ / 2, std::chrono::seconds(1)));
+	eviction_timer_.async_wait([this](beast::error_code ec) {
+		if (ec || closed_) {
+			return;
+		}
+		evict_idle();
+		schedule_eviction();
+	});
+}
+
+void Connection_Pool::evict_idle()
+{
+	auto stale = std::stable_partition(idle_.begin(), idle_.end(), [this](const std::shared_ptr<Connection>& connection) {
+		return is_healthy(*connection);
+	});
+	std::for_each(stale, idle_.end(), [this](const std::shared_ptr<Connection>& connection) {
+		discard(connection);
+	});
+	idle_.erase(stale, idle_.end());
+}
+
+std::size_t Connection_Pool::size() const
+{
+	return size_;
+}
+
+void Connection_Pool::close()
+{
+	closed_ = true;
+	eviction_timer_.cancel();
+	resolver_.cancel();
+
+	for (const auto& connection : idle_) {
+		discard(connection);
+	}
+	idle_.clear();
+
+	auto waiters = std::move(waiters_);
+	waiters_.clear();
+	for (auto& waiter : waiters) {
+		waiter(net::error::operation_aborted, nullptr);
+	}
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include "Connection.h"
+#include <deque>
+#include <vector>
+
+// A fixed size pool of keep-alive TLS connections to one host.
+// Connections are checked out for exactly one request and returned afterwards.
+// The DNS lookup and the latest TLS session are shared by all connections, so
+// replacing a dropped connection costs a TCP connect and an abbreviated handshake.
+// Every member function must be called from the thread running the io_context.
+class Connection_Pool {
+public:
+	using checkout_handler = std::function<void(boost::beast::error_code, std::shared_ptr<Connection>)>;
+
+private:
+	boost::asio::io_context& ioc_;
+	boost::asio::ssl::context& ctx_;
+	Body_Pool& bodies_;
+	Metrics& metrics_;
+	std::string const host_;
+	unsigned short const port_;
+	std::size_t const size_;
+	std::chrono::seconds const idle_timeout_;
+	boost::asio::ip::tcp::resolver resolver_;
+	boost::asio::ip::tcp::resolver::results_type endpoints_;
+	std::vector<std::function<void(boost::beast::error_code)>> resolve_waiters_;
+	Connection::session_type session_;
+	std::vector<std::shared_ptr<Connection>> idle_; // Most recently used at the back
+	std::size_t open_{ 0 }; // Idle, checked out or still connecting
+	std::deque<checkout_handler> waiters_;
+	boost::asio::steady_timer eviction_timer_;
+	bool closed_{ false };
+
+private:
+	void async_resolve(std::function<void(boost::beast::error_code)> handler);
+	void open_connection(checkout_handler handler);
+	bool is_healthy(const Connection& connection) const;
+	void discard(const std::shared_ptr<Connection>& connection);
+	// Hand a freed slot or an idle connection to the oldest queued checkout
+	void serve_waiter();
+	void schedule_eviction();
+	void evict_idle();
+
+public:
+	Connection_Pool(boost::asio::io_context& ioc, boost::asio::ssl::context& ctx, Body_Pool& bodies, Metrics& metrics, std::string host, unsigned short port,
+		std::size_t size, std::chrono::seconds idle_timeout);
+
+	// Open every connection up front so the first requests do not pay for the handshake.
+	// The handler receives the number of connections that came up.
+	void async_warm_up(std::function<void(std::size_t)> handler);
+
+	// Hand out a healthy idle connection, open a new one or wait for one to be returned
+	void async_checkout(checkout_handler handler);
+
+	// Give a connection back after its request completed
+	void checkin(std::shared_ptr<Connection> connection);
+
+	std::size_t size() const;
+
+	void close();
+};
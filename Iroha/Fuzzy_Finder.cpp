@@ -0,0 +1,242 @@
+#include "Fuzzy_Finder.h"
+#include <algorithm>
+#include <limits>
+
+namespace {
+	// Scoring constants from fzf
+	constexpr int score_match = 16;
+	constexpr int score_gap_start = -3;
+	constexpr int score_gap_extension = -1;
+	constexpr int bonus_boundary = score_match / 2;
+	constexpr int bonus_camel = bonus_boundary + score_gap_extension;
+	constexpr int bonus_consecutive = -(score_gap_start + score_gap_extension);
+	constexpr int bonus_first_multiplier = 2;
+	constexpr int no_match = std::numeric_limits<int>::min();
+
+	char lower(char c)
+	{
+		return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+	}
+
+	bool is_alnum(char c)
+	{
+		return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9');
+	}
+
+	// Letters and digits get a bit each, everything else shares the remaining bits
+	std::uint64_t character_bit(char c)
+	{
+		auto const byte = static_cast<unsigned char>(c);
+		if (byte >= 'a' && byte <= 'z') {
+			return std::uint64_t{ 1 } << (byte - 'a');
+		}
+		if (byte >= '0' && byte <= '9') {
+			return std::uint64_t{ 1 } << (26 + byte - '0');
+		}
+		return std::uint64_t{ 1 } << (36 + byte % 28);
+	}
+
+	// Bonus for matching the character at position i of the original name
+	int position_bonus(std::string_view name, std::size_t i)
+	{
+		if (i == 0 || !is_alnum(name[i - 1])) {
+			return is_alnum(name[i]) ? bonus_boundary : 0;
+		}
+		auto const previous = name[i - 1];
+		auto const current = name[i];
+		if ((previous >= 'a' && previous <= 'z' && current >= 'A' && current <= 'Z')
+			|| (!(previous >= '0' && previous <= '9') && current >= '0' && current <= '9')) {
+			return bonus_camel;
+		}
+		return 0;
+	}
+}
+
+void Fuzzy_Finder::clear()
+{
+	lowered_.clear();
+	dead_ = 0;
+	candidates_.clear();
+	by_id_.clear();
+}
+
+void Fuzzy_Finder::store(Candidate& candidate)
+{
+	candidate.offset = static_cast<std::uint32_t>(lowered_.size());
+	candidate.length = static_cast<std::uint32_t>(candidate.name.size());
+	candidate.characters = 0;
+	for (auto c : candidate.name) {
+		auto const lowered = lower(c);
+		lowered_ += lowered;
+		candidate.characters |= character_bit(lowered);
+	}
+}
+
+void Fuzzy_Finder::compact()
+{
+	if (dead_ <= 64 * 1024 || dead_ <= lowered_.size() / 2) {
+		return;
+	}
+
+	std::string lowered;
+	lowered.reserve(lowered_.size() - dead_);
+	for (auto& candidate : candidates_) {
+		auto const offset = static_cast<std::uint32_t>(lowered.size());
+		lowered.append(lowered_, candidate.offset, candidate.length);
+		candidate.offset = offset;
+	}
+	lowered_ = std::move(lowered);
+	dead_ = 0;
+}
+
+void Fuzzy_Finder::update(const Object_Id& trello_id, std::uint32_t depth, std::string_view name)
+{
+	auto it = by_id_.find(trello_id);
+	if (it == by_id_.end()) {
+		Candidate candidate{ trello_id, depth, name, 0, 0, 0 };
+		store(candidate);
+		by_id_[trello_id] = static_cast<std::uint32_t>(candidates_.size());
+		candidates_.push_back(candidate);
+		return;
+	}
+
+	auto& candidate = candidates_[it->second];
+	candidate.depth = depth;
+	if (candidate.name.data() == name.data() && candidate.name.size() == name.size()) {
+		return;
+	}
+
+	// Renamed, the old lower cased name stays behind until the next compaction
+	dead_ += candidate.length;
+	candidate.name = name;
+	store(candidate);
+	compact();
+}
+
+void Fuzzy_Finder::erase(const Object_Id& trello_id)
+{
+	auto it = by_id_.find(trello_id);
+	if (it == by_id_.end()) {
+		return;
+	}
+
+	// The last candidate takes the free slot
+	auto const number = it->second;
+	by_id_.erase(it);
+	dead_ += candidates_[number].length;
+	if (number + 1 != candidates_.size()) {
+		candidates_[number] = candidates_.back();
+		by_id_[candidates_[number].trello_id] = number;
+	}
+	candidates_.pop_back();
+	compact();
+}
+
+int Fuzzy_Finder::score(const Candidate& candidate, std::string_view pattern) const
+{
+	std::string_view const text(lowered_.data() + candidate.offset, candidate.length);
+
+	// Forward: the earliest position where the whole pattern has been seen
+	std::size_t p = 0;
+	std::size_t end = 0;
+	for (std::size_t i = 0; i < text.size() && p < pattern.size(); ++i) {
+		if (text[i] == pattern[p]) {
+			++p;
+			end = i + 1;
+		}
+	}
+	if (p < pattern.size()) {
+		return no_match;
+	}
+
+	// Backward: the latest start that still fits, which gives the tightest window
+	auto start = end;
+	for (auto q = pattern.size(); q > 0;) {
+		--start;
+		if (text[start] == pattern[q - 1]) {
+			--q;
+		}
+	}
+
+	// Score the window
+	int total = 0;
+	int consecutive = 0;
+	int first_bonus = 0;
+	bool in_gap = false;
+	p = 0;
+	for (auto i = start; i < end; ++i) {
+		if (p < pattern.size() && text[i] == pattern[p]) {
+			auto bonus = position_bonus(candidate.name, i);
+			if (consecutive == 0) {
+				first_bonus = bonus;
+			}
+			else {
+				// A run keeps the bonus of its first character
+				bonus = std::max({ bonus, first_bonus, bonus_consecutive });
+			}
+			total += score_match + (p == 0 ? bonus * bonus_first_multiplier : bonus);
+			++consecutive;
+			in_gap = false;
+			++p;
+		}
+		else {
+			total += in_gap ? score_gap_extension : score_gap_start;
+			consecutive = 0;
+			in_gap = true;
+		}
+	}
+	return total;
+}
+
+std::vector<Fuzzy_Finder::Match> Fuzzy_Finder::find(std::string_view pattern, std::size_t limit) const
+{
+	std::string lowered;
+	std::uint64_t characters = 0;
+	for (auto c : pattern) {
+		if (c != ' ' && c != '\t') {
+			lowered += lower(c);
+			characters |= character_bit(lower(c));
+		}
+	}
+	if (lowered.empty()) {
+		return {};
+	}
+
+	std::vector<Match> matches;
+	for (const auto& candidate : candidates_) {
+		// Cheap reject: some pattern character does not occur in the name at all
+		if ((candidate.characters & characters) != characters || candidate.length < lowered.size()) {
+			continue;
+		}
+
+		auto const value = score(candidate, lowered);
+		if (value != no_match) {
+			matches.push_back({ candidate.trello_id, candidate.depth, candidate.name, value });
+		}
+	}
+
+	auto better = [](const Match& a, const Match& b) {
+		if (a.score != b.score) {
+			return a.score > b.score;
+		}
+		if (a.name.size() != b.name.size()) {
+			return a.name.size() < b.name.size();
+		}
+		// Trello IDs start with their creation time, older items first
+		return a.trello_id.bytes < b.trello_id.bytes;
+	};
+
+	if (matches.size() > limit) {
+		std::partial_sort(matches.begin(), matches.begin() + limit, matches.end(), better);
+		matches.resize(limit);
+	}
+	else {
+		std::sort(matches.begin(), matches.end(), better);
+	}
+	return matches;
+}
+
+std::size_t Fuzzy_Finder::size() const
+{
+	return candidates_.size();
+}
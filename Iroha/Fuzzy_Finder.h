@@ -0,0 +1,59 @@
+#pragma once
+#include "Object_Id.h"
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <robin-hood-hashing/robin_hood.h>
+
+// fzf style fuzzy matching over the names of every mirrored board, list and card.
+// The pattern characters must appear in order, not necessarily next to each other.
+// Matches score higher when the characters are consecutive, start words or follow a case change,
+// and lower for every skipped character.
+// All names are kept lower cased in one buffer with a 64 bit character set per name,
+// so most candidates are rejected with a single AND before any character is compared.
+// Items are keyed by Trello ID and updated one by one as the mirror changes.
+class Fuzzy_Finder {
+public:
+	struct Match {
+		Object_Id trello_id;
+		std::uint32_t depth; // 1 is a board, 2 a list and 3 a card
+		std::string_view name;
+		int score;
+	};
+
+private:
+	struct Candidate {
+		Object_Id trello_id;
+		std::uint32_t depth;
+		std::string_view name; // Original spelling, owned by the mirror's string pool
+		std::uint32_t offset; // Into lowered_
+		std::uint32_t length;
+		std::uint64_t characters; // Bit set of the characters in the name
+	};
+
+	std::string lowered_;
+	std::size_t dead_{ 0 }; // Bytes of lowered_ no candidate uses any more
+	std::vector<Candidate> candidates_;
+	robin_hood::unordered_flat_map<Object_Id, std::uint32_t, Object_Id::Hash> by_id_; // Trello ID to its candidate
+
+private:
+	// Score of the tightest match of the lower cased pattern, or the lowest int if it does not match
+	int score(const Candidate& candidate, std::string_view pattern) const;
+	// Lower case the name into the end of lowered_
+	void store(Candidate& candidate);
+	// Copy the live names into a new buffer once most of it is dead
+	void compact();
+
+public:
+	void clear();
+	// Add an item or take its new name. Interned names are compared by their views,
+	// the name must stay valid until the next clear() or update of the item.
+	void update(const Object_Id& trello_id, std::uint32_t depth, std::string_view name);
+	void erase(const Object_Id& trello_id);
+
+	// Best matches first. Spaces in the pattern are ignored.
+	std::vector<Match> find(std::string_view pattern, std::size_t limit) const;
+	std::size_t size() const;
+};
@@ -25,48 +25,60 @@ void Client::make_secrect()
 
 	// Prepend "?" if secrect is the only thing that need to append to URL else prepend "&"
 	secrect_ = fmt::format("key={}&token={}", key, token);
-}
 
-void Client::init()
-{
-	// Set SNI Hostname (many hosts need this to handshake successfully)
-	if (!SSL_set_tlsext_host_name(stream_.native_handle(), host_.c_str()))
-	{
-		beast::error_code ec{ static_cast<int>(::ERR_get_error()), net::error::get_ssl_category() };
-		fmt::print("{}\n", ec.message());
-		return;
+	// Optional connection settings
+	if (config["Connections"]) {
+		engine_options_.connections = config["Connections"].as<std::size_t>();
+	}
+	if (config["Idle_Timeout"]) {
+		engine_options_.idle_timeout = std::chrono::seconds(config["Idle_Timeout"].as<long>());
+	}
+	if (config["Pipelining"]) {
+		engine_options_.pipelining = config["Pipelining"].as<bool>();
+	}
+	if (config["Pipeline_Depth"]) {
+		engine_options_.pipeline_depth = config["Pipeline_Depth"].as<std::size_t>();
+	}
+	if (config["Retry_Attempts"]) {
+		engine_options_.retry.max_attempts = config["Retry_Attempts"].as<std::size_t>();
 	}
 
-	// Look up the domain name
-	auto const results = resolver_.resolve(host_, std::to_string(port_));
-
-	// Make the connection on the IP address we get from a lookup
-	beast::get_lowest_layer(stream_).connect(results);
+	// Optional local cache settings
+	if (config["Fresh_For"]) {
+		fresh_for_ = std::chrono::seconds(config["Fresh_For"].as<long>());
+	}
+	if (config["Resident_Cards"]) {
+		resident_cards_ = config["Resident_Cards"].as<std::size_t>();
+	}
+}
 
-	// Perform the SSL handshake
-	stream_.handshake(ssl::stream_base::client);
+bool Client::init()
+{
+	auto const start = std::chrono::steady_clock::now();
+	engine_ = std::make_unique<Request_Engine>(ioc_, ctx_, host_, port_, version_, engine_options_);
+	if (!engine_->start()) {
+		return false;
+	}
 
-	// Set up an HTTP GET request message
-	req_.version(version_);
-	req_.set(http::field::host, host_);
-	req_.set(http::field::user_agent, BOOST_BEAST_VERSION_STRING);
+	engine_->metrics().record("startup", start);
+	return true;
 }
 
-void Client::make_request(http::verb type, const std::string& target)
+http::response<http::string_body> Client::make_request(http::verb type, const std::string& target)
 {
-	req_.method(type);
-	req_.target(target);
+	return engine_->request(type, target);
 }
 
-std::string Client::trim_to_new_line(const std::string& input)
+std::string Client::trim_to_new_line(std::string_view input)
 {
-	auto pos = input.find("\n");
+	auto pos = input.find('\n');
 
-	if (pos == std::string::npos) {
+	if (pos == std::string_view::npos) {
 		// Return full string if there is only one
-		return input;
+		return std::string(input);
 	}
 
+	// Only the first line is copied, straight into the preview
 	return fmt::format("{}...", input.substr(0, pos));
 }
 
@@ -86,6 +98,10 @@ void Client::create_help_table()
 	items.add_row({ "create [ID]" , "Create new Boards/Lists/Cards" });
 	items.add_row({ "update [ID]" , "Update Boards/Lists/Cards" });
 	items.add_row({ "close [ID]" , "Close Boards/Lists/Cards" });
+	items.add_row({ "crawl" , "Download all Boards, Lists and Cards" });
+	items.add_row({ "search [text]" , "Find Cards by name and description" });
+	items.add_row({ "find [text]" , "Fuzzy find Boards/Lists/Cards by name" });
+	items.add_row({ "stats [json]" , "Display request, parse and render timings" });
 	items.add_row({ "quit or q" , "Quit the application" });
 	items.add_row({ "help or h" , "Display available commands" });
 
@@ -129,12 +145,24 @@ std::string Client::force_line_break(const std::string& input, unsigned short nu
 }
 
 Client::Client(boost::asio::io_context& ioc, ssl::context& ctx) :
-	resolver_{ ioc },
-	stream_{ ioc, ctx }
+	ioc_{ ioc },
+	ctx_{ ctx },
+	mirror_{ std::filesystem::current_path() / "Iroha.cache" }
 {
 	make_secrect();
+
+	// Whatever the last session saw is available before the first request
+	if (mirror_.load()) {
+		number({}, mirror_.boards());
+		reindex_mirror();
+	}
+
 	if (!secrect_.empty()) {
-		init();
+		if (!init()) {
+			// Without a connection there is nothing to do
+			secrect_.clear();
+			return;
+		}
 		create_help_table();
 		display_help();
 	}
@@ -142,60 +170,580 @@ Client::Client(boost::asio::io_context& ioc, ssl::context& ctx) :
 
 Client::~Client()
 {
-	// Gracefully close the stream. Ignore all error.
-	beast::error_code ec;
-	stream_.shutdown(ec);
+	// Gracefully close the connection and stop the io thread.
+	if (engine_) {
+		engine_->stop();
+	}
+
+	drain_inbox();
+	if (mirror_dirty_ && !mirror_.save()) {
+		fmt::print("Cannot save the local mirror.\n");
+	}
 }
 
 Client::Client(Client&& other) noexcept :
-	resolver_(std::move(other.resolver_)),
-	stream_(std::move(other.stream_)),
-	req_(std::move(other.req_)),
-	buffer_(std::move(other.buffer_)),
+	ioc_(other.ioc_),
+	ctx_(other.ctx_),
+	engine_options_(other.engine_options_),
+	engine_(std::move(other.engine_)),
 	secrect_(std::move(other.secrect_)),
-	boards_map_(std::move(other.boards_map_)),
+	index_(std::move(other.index_)),
+	search_index_(std::move(other.search_index_)),
+	finder_(std::move(other.finder_)),
+	mirror_(std::move(other.mirror_)),
+	mirror_dirty_(other.mirror_dirty_),
+	resident_(std::move(other.resident_)),
+	fresh_for_(other.fresh_for_),
+	resident_cards_(other.resident_cards_),
 	help_table_(std::move(other.help_table_))
 {
 }
 
 Client& Client::operator=(Client&& other) noexcept
 {
-	std::swap(resolver_, other.resolver_);
-	std::swap(stream_, other.stream_);
-	std::swap(req_, other.req_);
-	std::swap(buffer_, other.buffer_);
+	std::swap(engine_options_, other.engine_options_);
+	std::swap(engine_, other.engine_);
 	std::swap(secrect_, other.secrect_);
-	std::swap(boards_map_, other.boards_map_);
+	std::swap(index_, other.index_);
+	std::swap(search_index_, other.search_index_);
+	std::swap(finder_, other.finder_);
+	std::swap(mirror_, other.mirror_);
+	std::swap(mirror_dirty_, other.mirror_dirty_);
+	std::swap(resident_, other.resident_);
+	std::swap(fresh_for_, other.fresh_for_);
+	std::swap(resident_cards_, other.resident_cards_);
 	std::swap(help_table_, other.help_table_);
 
 	return *this;
 }
 
-void Client::view_board()
+std::string Client::boards_target() const
 {
-	if (boards_map_.size() != 0) {
-		boards_map_.clear();
-	}
+	return fmt::format("/1/members/me/boards?fields=name&filter=open&{}", secrect_);
+}
 
-	http::response<http::string_body> res;
+std::string Client::lists_target(const Object_Id& board_trello_id) const
+{
+	return fmt::format("/1/boards/{}/lists?{}", board_trello_id.to_string(), secrect_);
+}
 
-	auto const target = fmt::format("/1/members/me/boards?fields=name&filter=open&{}", secrect_);
-	make_request(http::verb::get, target);
+std::string Client::cards_target(const Object_Id& list_trello_id) const
+{
+	// Currently only need to get id, name and desciption of a card
+	return fmt::format("/1/lists/{}/cards?fields=name,desc,id,pos&{}", list_trello_id.to_string(), secrect_);
+}
 
-	// Send the HTTP request to the remote host
-	http::write(stream_, req_);
+std::string Client::card_target(const Object_Id& card_trello_id) const
+{
+	return fmt::format("/1/cards/{}?fields=name,desc&{}", card_trello_id.to_string(), secrect_);
+}
 
-	// Receive the HTTP response
-	http::read(stream_, buffer_, res);
+std::optional<std::vector<Local_Mirror::Fetched>> Client::parse_records(const std::string& target, const std::string& body)
+{
+	// Only id, name, desc and pos are kept, straight from the parser without a JSON document
+	auto const start = std::chrono::steady_clock::now();
+	auto records = Record_Decoder::decode(body);
+	engine_->metrics().record(Metrics::endpoint(http::verb::get, target) + ".parse", start);
+	return records;
+}
 
-	// Write the message to standard out
-	//std::cout << res << std::endl;
+std::optional<std::vector<Local_Mirror::Fetched>> Client::mirrored(const Response_Cache::Mirror_Key& key)
+{
+	using Level = Response_Cache::Mirror_Key::Level;
+
+	// Without the children, applying the copies keeps the children that are mirrored already
+	auto copy = [](const Local_Mirror::Record& record) {
+		Local_Mirror::Fetched copy;
+		copy.trello_id = record.trello_id;
+		copy.name = record.name;
+		copy.desc = record.desc;
+		copy.pos = record.pos;
+		return copy;
+	};
+	auto copy_all = [&copy](const std::vector<Local_Mirror::Record>& records) {
+		std::vector<Local_Mirror::Fetched> copies;
+		copies.reserve(records.size());
+		std::transform(records.begin(), records.end(), std::back_inserter(copies), copy);
+		return copies;
+	};
+
+	// Collections that are not fully mirrored have to be downloaded again
+	switch (key.level) {
+	case Level::boards:
+		return copy_all(mirror_.boards());
+	case Level::lists:
+		if (auto board = mirror_.find_board(key.trello_id); board != nullptr && board->loaded) {
+			return copy_all(board->children);
+		}
+		break;
+	case Level::cards:
+		if (auto list = mirror_.find_list(key.trello_id); list != nullptr && list->loaded) {
+			return copy_all(list->children);
+		}
+		break;
+	case Level::card:
+		if (auto card = mirror_.find_card(key.trello_id)) {
+			return std::vector<Local_Mirror::Fetched>{ copy(*card) };
+		}
+		break;
+	}
+	return std::nullopt;
+}
+
+std::optional<std::vector<Local_Mirror::Fetched>> Client::fetch_records(const std::string& target, const Response_Cache::Mirror_Key& key,
+	const std::string& action)
+{
+	// Send the HTTP request to the remote host and wait for the response.
+	// If the target was seen before the request is conditional and may come back as 304.
+	auto res = engine_->request(http::verb::get, target, responses_.validators(target));
+
+	if (res.result() == http::status::not_modified) {
+		if (auto cached = responses_.find(target)) {
+			if (auto records = mirrored(*cached)) {
+				return records;
+			}
+		}
+		res = make_request(http::verb::get, target);
+	}
+
+	if (res.result() != http::status::ok) {
+		fmt::print("{} failed: {}: {}\n", action, res.result_int(), res.reason().to_string());
+		return std::nullopt;
+	}
 
 	if (res.body().empty()) {
 		fmt::print("Wow, such empty.\n");
+		return std::nullopt;
+	}
+
+	auto records = parse_records(target, res.body());
+	if (!records) {
+		fmt::print("{} failed: the response from Trello is incomplete.\n", action);
+		return std::nullopt;
+	}
+	// The caller mirrors the records right away
+	responses_.store(target, res.base(), key);
+	engine_->release(std::move(res));
+	return records;
+}
+
+void Client::refresh_in_background(std::string target, Response_Cache::Mirror_Key key, std::function<void(std::vector<Local_Mirror::Fetched>)> apply)
+{
+	auto validators = responses_.validators(target);
+	engine_->async_request(http::verb::get, target, validators, [this, target, key = std::move(key), apply = std::move(apply)](beast::error_code ec, http::response<http::string_body> res) {
+		if (!ec && res.result() == http::status::not_modified) {
+			// The mirror can only be read on the main thread
+			post_to_main([this, target, apply]() {
+				if (auto cached = responses_.find(target)) {
+					if (auto records = mirrored(*cached)) {
+						apply(std::move(*records));
+					}
+				}
+			});
+			return;
+		}
+
+		if (ec || res.result() != http::status::ok) {
+			// Keep showing the mirrored data
+			return;
+		}
+
+		// Parse on the io thread, only the cheap update runs on the main thread.
+		// An invalid body is dropped, the mirror is kept as it is.
+		auto parsed = parse_records(target, res.body());
+		if (!parsed) {
+			return;
+		}
+
+		auto records = std::make_shared<std::vector<Local_Mirror::Fetched>>(std::move(*parsed));
+		post_to_main([this, target, key, header = res.base(), apply, records]() {
+			apply(std::move(*records));
+			// Only now does the mirror hold what a 304 stands for
+			responses_.store(target, header, key);
+		});
+		engine_->release(std::move(res));
+	});
+}
+
+void Client::prefetch_lists()
+{
+	// Older guesses are no longer on screen
+	engine_->cancel_background();
+
+	// All guesses share one /1/batch call
+	Batch_Queue batch(*engine_, secrect_);
+	std::size_t queued = 0;
+	for (const auto& board : mirror_.boards()) {
+		if (queued == prefetch_limit) {
+			break;
+		}
+		if (resident_.was_fetched(board.trello_id)) {
+			continue;
+		}
+
+		++queued;
+		batch.enqueue(fmt::format("/boards/{}/lists", board.trello_id.to_string()), [this, board_trello_id = board.trello_id](Batch_Queue::Result result) {
+			if (result.status != 200) {
+				return;
+			}
+			auto lists = std::make_shared<std::vector<Local_Mirror::Fetched>>(std::move(result.records));
+			post_to_main([this, board_trello_id, lists]() {
+				apply_lists(board_trello_id, std::move(*lists));
+			});
+		});
+	}
+	batch.flush(true);
+}
+
+void Client::prefetch_cards(const Local_Mirror::Record& board)
+{
+	engine_->cancel_background();
+
+	Batch_Queue batch(*engine_, secrect_);
+	std::size_t queued = 0;
+	for (const auto& list : board.children) {
+		if (queued == prefetch_limit) {
+			break;
+		}
+		if (resident_.was_fetched(list.trello_id)) {
+			continue;
+		}
+
+		++queued;
+		batch.enqueue(fmt::format("/lists/{}/cards?fields=name,desc,id,pos", list.trello_id.to_string()), [this, list_trello_id = list.trello_id](Batch_Queue::Result result) {
+			if (result.status != 200) {
+				return;
+			}
+			auto cards = std::make_shared<std::vector<Local_Mirror::Fetched>>(std::move(result.records));
+			post_to_main([this, list_trello_id, cards]() {
+				apply_cards(list_trello_id, std::move(*cards));
+			});
+		});
+	}
+	batch.flush(true);
+}
+
+void Client::post_to_main(std::function<void()> update)
+{
+	std::lock_guard<std::mutex> lock(inbox_mutex_);
+	inbox_.push_back(std::move(update));
+}
+
+void Client::drain_inbox()
+{
+	std::vector<std::function<void()>> updates;
+	{
+		std::lock_guard<std::mutex> lock(inbox_mutex_);
+		updates.swap(inbox_);
+	}
+
+	for (auto& update : updates) {
+		update();
+	}
+}
+
+bool Client::apply_actions(const Object_Id& board_trello_id, const nlohmann::json& actions)
+{
+	if (!Sync_Engine(mirror_).apply(board_trello_id, actions)) {
+		// Too much changed since the last sync, download the board again on its next view
+		if (auto board = mirror_.find_board(board_trello_id)) {
+			board->last_action.clear();
+			board->loaded = false;
+			for (auto& list : board->children) {
+				list.loaded = false;
+			}
+		}
+		return false;
+	}
+
+	// Everything mirrored for this board is current now
+	if (auto board = mirror_.find_board(board_trello_id)) {
+		resident_.mark_fetched(board_trello_id);
+		for (const auto& list : board->children) {
+			if (list.loaded) {
+				resident_.mark_fetched(list.trello_id);
+			}
+		}
+	}
+	mirror_dirty_ = true;
+	// New lists and cards get their IDs when their collection is printed
+	follow_mirror();
+	return true;
+}
+
+bool Client::sync_board(const Object_Id& board_trello_id)
+{
+	auto board = mirror_.find_board(board_trello_id);
+	if (board == nullptr || !board->loaded || board->last_action.empty()) {
+		return false;
+	}
+
+	auto res = make_request(http::verb::get, Sync_Engine::target(board_trello_id, board->last_action, secrect_));
+	if (res.result() != http::status::ok) {
+		return false;
+	}
+
+	auto actions = nlohmann::json::parse(res.body(), nullptr, false);
+	engine_->release(std::move(res));
+	return apply_actions(board_trello_id, actions);
+}
+
+void Client::sync_in_background(const Object_Id& board_trello_id)
+{
+	auto board = mirror_.find_board(board_trello_id);
+	if (board == nullptr) {
+		return;
+	}
+
+	if (board->last_action.empty()) {
+		// Nothing to start a delta from, download the lists and remember where the feed is
+		seed_in_background(board_trello_id);
+		refresh_in_background(lists_target(board_trello_id), { Response_Cache::Mirror_Key::Level::lists, board_trello_id }, [this, board_trello_id](std::vector<Local_Mirror::Fetched> lists) {
+			apply_lists(board_trello_id, std::move(lists));
+		});
+		return;
+	}
+
+	auto const target = Sync_Engine::target(board_trello_id, board->last_action, secrect_);
+	engine_->async_request(http::verb::get, target, [this, board_trello_id](beast::error_code ec, http::response<http::string_body> res) {
+		if (ec || res.result() != http::status::ok) {
+			return;
+		}
+
+		auto actions = std::make_shared<nlohmann::json>(nlohmann::json::parse(res.body(), nullptr, false));
+		engine_->release(std::move(res));
+		post_to_main([this, board_trello_id, actions]() {
+			apply_actions(board_trello_id, *actions);
+		});
+	});
+}
+
+void Client::seed_in_background(const Object_Id& board_trello_id)
+{
+	engine_->async_request(http::verb::get, Sync_Engine::target(board_trello_id, "", secrect_),
+		[this, board_trello_id](beast::error_code ec, http::response<http::string_body> res) {
+		if (ec || res.result() != http::status::ok) {
+			return;
+		}
+
+		auto newest = std::make_shared<nlohmann::json>(nlohmann::json::parse(res.body(), nullptr, false));
+		engine_->release(std::move(res));
+		post_to_main([this, board_trello_id, newest]() {
+			auto board = mirror_.find_board(board_trello_id);
+			if (board != nullptr && board->last_action.empty() && Sync_Engine(mirror_).apply(board_trello_id, *newest)) {
+				mirror_dirty_ = true;
+			}
+		});
+	});
+}
+
+void Client::show_lists_after_change(const std::string& board_id)
+{
+	auto board = find_item(board_id, 1);
+	if (board == nullptr) {
+		return;
+	}
+
+	// Apply the change from the actions feed instead of downloading every list again
+	auto const trello_id = board->trello_id;
+	if (sync_board(trello_id)) {
+		if (auto record = mirror_.find_board(trello_id)) {
+			print_lists(board_id, *record);
+			return;
+		}
+	}
+
+	view_list(board_id, true);
+}
+
+void Client::show_cards_after_change(const std::string& list_id)
+{
+	auto list = find_item(list_id, 2);
+	if (list == nullptr) {
+		return;
+	}
+
+	auto const trello_id = list->trello_id;
+	auto board = mirror_.find_list_parent(trello_id);
+
+	if (board != nullptr && sync_board(board->trello_id)) {
+		if (auto record = mirror_.find_list(trello_id)) {
+			print_cards(list_id, *record);
+			return;
+		}
+	}
+
+	view_card(list_id, true);
+}
+
+void Client::number(const Item_Index::Path& parent, const std::vector<Local_Mirror::Record>& children)
+{
+	std::uint32_t i = 0;
+	for (; i < children.size(); ++i) {
+		auto const path = parent.child(i);
+		auto const item = index_.find(path);
+		if (item != nullptr && item->trello_id == children[i].trello_id) {
+			// Same item at the same place, the IDs below it stay what the user saw
+			continue;
+		}
+
+		// Whatever was numbered at this position belongs to another item now
+		index_.erase(path);
+		index_.add(path, children[i].trello_id);
+		if (path.depth < 3) {
+			number(path, children[i].children);
+		}
+	}
+
+	// Positions past the end are gone
+	for (; index_.find(parent.child(i)) != nullptr; ++i) {
+		index_.erase(parent.child(i));
+	}
+}
+
+void Client::number_new(const Local_Mirror::Record* parent)
+{
+	Item_Index::Path path{};
+	if (parent != nullptr) {
+		auto const position = index_.path_of(parent->trello_id);
+		if (position == nullptr) {
+			return;
+		}
+		path = *position;
+	}
+
+	if (index_.find(path.child(0)) == nullptr) {
+		number(path, parent != nullptr ? parent->children : mirror_.boards());
+	}
+}
+
+void Client::follow_mirror()
+{
+	for (const auto& change : mirror_.take_changes()) {
+		auto record = mirror_.find(change.trello_id, change.depth);
+		if (record == nullptr) {
+			finder_.erase(change.trello_id);
+			search_index_.erase(change.trello_id);
+			continue;
+		}
+
+		// Unchanged text is recognized by its interned view and costs a lookup
+		finder_.update(record->trello_id, change.depth, record->name);
+		if (change.depth == 3) {
+			search_index_.update(record->trello_id, record->name, record->desc);
+		}
+	}
+}
+
+void Client::reindex_mirror()
+{
+	mirror_.take_changes();
+	finder_.clear();
+	search_index_.begin_update();
+	for (const auto& board : mirror_.boards()) {
+		finder_.update(board.trello_id, 1, board.name);
+		for (const auto& list : board.children) {
+			finder_.update(list.trello_id, 2, list.name);
+			for (const auto& card : list.children) {
+				finder_.update(card.trello_id, 3, card.name);
+				search_index_.update(card.trello_id, card.name, card.desc);
+			}
+		}
+	}
+	search_index_.end_update();
+}
+
+const Item_Index::Item* Client::find_item(const std::string& id, std::uint32_t depth) const
+{
+	auto path = Item_Index::parse(id);
+	if (!path || path->depth != depth) {
+		return nullptr;
+	}
+	return index_.find(*path);
+}
+
+void Client::apply_boards(std::vector<Local_Mirror::Fetched> boards)
+{
+	mirror_.set_boards(boards);
+	resident_.mark_fetched(workspace_id);
+	mirror_dirty_ = true;
+	follow_mirror();
+	number_new(nullptr);
+}
+
+void Client::apply_lists(const Object_Id& board_trello_id, std::vector<Local_Mirror::Fetched> lists)
+{
+	mirror_.set_lists(board_trello_id, lists);
+	resident_.mark_fetched(board_trello_id);
+	mirror_dirty_ = true;
+	follow_mirror();
+	number_new(mirror_.find_board(board_trello_id));
+}
+
+void Client::apply_cards(const Object_Id& list_trello_id, std::vector<Local_Mirror::Fetched> cards)
+{
+	mirror_.set_cards(list_trello_id, cards);
+	resident_.mark_fetched(list_trello_id);
+	trim_resident(list_trello_id);
+	mirror_dirty_ = true;
+	follow_mirror();
+	number_new(mirror_.find_list(list_trello_id));
+}
+
+void Client::trim_resident(const Object_Id& keep_list_trello_id)
+{
+	std::size_t cards = 0;
+	for (const auto& board : mirror_.boards()) {
+		for (const auto& list : board.children) {
+			cards += list.children.size();
+		}
+	}
+
+	// Oldest first. Lists never viewed in this session are not in the order and are kept as well.
+	// The IDs are collected first, forget() erases from the order being walked.
+	std::vector<Object_Id> evicted;
+	const auto& order = resident_.by_recency();
+	for (auto it = order.rbegin(); it != order.rend() && cards > resident_cards_; ++it) {
+		auto list = mirror_.find_list(*it);
+		if (list == nullptr || *it == keep_list_trello_id || list->children.empty()) {
+			continue;
+		}
+
+		cards -= list->children.size();
+		mirror_.unload_cards(*it);
+		evicted.push_back(*it);
+	}
+
+	for (const auto& id : evicted) {
+		resident_.forget(id);
+		mirror_dirty_ = true;
+	}
+
+	// The text of the dropped cards is freed with the old pool, every view the finder
+	// and the search index hold is gone with it
+	if (!evicted.empty() && mirror_.compact()) {
+		search_index_.clear();
+		reindex_mirror();
+	}
+}
+
+void Client::apply_card(const Object_Id& card_trello_id, std::vector<Local_Mirror::Fetched> card)
+{
+	auto record = mirror_.find_card(card_trello_id);
+	if (record == nullptr || card.empty()) {
 		return;
 	}
 
+	mirror_.set_name(*record, 3, card.front().name);
+	mirror_.set_desc(*record, 3, card.front().desc);
+	resident_.mark_fetched(card_trello_id);
+	mirror_dirty_ = true;
+	follow_mirror();
+}
+
+void Client::print_boards()
+{
+	auto const start = std::chrono::steady_clock::now();
 	tabulate::Table header;
 	header.add_row({ "Workspace" });
 	header[0][0].format()
@@ -207,14 +755,13 @@ void Client::view_board()
 	tabulate::Table boards;
 	boards.add_row({ "ID", "Name" });
 
-	nlohmann::json body = nlohmann::json::parse(res.body());
-	for (auto i = 0; i < body.size(); ++i) {
-		boards.add_row({ std::to_string(i), body[i].find("name").value() });
-		Item board{ body[i].find("id").value() , body[i].find("name").value() };
-		boards_map_.emplace(std::to_string(i), board);
+	const auto& records = mirror_.boards();
+	for (std::size_t i = 0; i < records.size(); ++i) {
+		boards.add_row({ std::to_string(i), std::string(records[i].name) });
 	}
+	number({}, records);
 
-	for (auto i = 0; i < body.size(); i++) {
+	for (std::size_t i = 0; i < records.size(); i++) {
 		// Force fixed size
 		boards[i][0].format().width(10);
 		boards[i][1].format().width(25);
@@ -223,9 +770,7 @@ void Client::view_board()
 	for (auto i = 0; i < 2; i++) {
 		// Center all the collumns of the first row
 		boards[0][i].format()
-			// For some reason if embedded inside another table
-			// the header cannot be colored
-			//.font_color(tabulate::Color::green)
+			.font_color(tabulate::Color::green)
 			.font_align(tabulate::FontAlign::center)
 			.font_style({ tabulate::FontStyle::bold });
 	}
@@ -234,42 +779,16 @@ void Client::view_board()
 	header[1].format().hide_border_top();
 
 	std::cout << header << std::endl;
+	engine_->metrics().record("boards.render", start);
+	// While the table is being read
+	prefetch_lists();
 }
 
-void Client::view_list(const std::string& board_id)
+void Client::print_lists(const std::string& board_id, const Local_Mirror::Record& board)
 {
-	if (lists_map_.size() != 0) {
-		lists_map_.clear();
-	}
-
-	// Search for trello ID using user-friendly board ID
-	auto board = boards_map_.find(board_id);
-
-	if (board == boards_map_.end()) {
-		fmt::print("View list failed. Cannot find board with ID: {}\n", board_id);
-		return;
-	}
-
-	http::response<http::string_body> res;
-	auto const target = fmt::format("/1/boards/{}/lists?{}", board->second.trello_id, secrect_);
-	make_request(http::verb::get, target);
-
-	// Send the HTTP request to the remote host
-	http::write(stream_, req_);
-
-	// Receive the HTTP response
-	http::read(stream_, buffer_, res);
-
-	// Write the message to standard out
-	//std::cout << res << std::endl;
-
-	if (res.body().empty()) {
-		fmt::print("Wow, such empty.\n");
-		return;
-	}
-
+	auto const start = std::chrono::steady_clock::now();
 	tabulate::Table header;
-	header.add_row({ board->second.name });
+	header.add_row({ std::string(board.name) });
 	header[0][0].format()
 		.font_color(tabulate::Color::green)
 		.font_align(tabulate::FontAlign::center)
@@ -279,15 +798,16 @@ void Client::view_list(const std::string& board_id)
 	tabulate::Table lists;
 	lists.add_row({ "ID", "Name" });
 
-	nlohmann::json body = nlohmann::json::parse(res.body());
-	for (auto i = 0; i < body.size(); ++i) {
+	const auto& records = board.children;
+	for (std::size_t i = 0; i < records.size(); ++i) {
 		auto list_id = fmt::format("{}-{}", board_id, i); // Prepend the user-friendly board ID
-		lists.add_row({ list_id, body[i].find("name").value() });
-		Item list{ body[i].find("id").value() , body[i].find("name").value() };
-		lists_map_.emplace(list_id, list);
+		lists.add_row({ list_id, std::string(records[i].name) });
+	}
+	if (auto path = Item_Index::parse(board_id)) {
+		number(*path, records);
 	}
 
-	for (auto i = 0; i < body.size(); i++) {
+	for (std::size_t i = 0; i < records.size(); i++) {
 		// Force fixed size
 		lists[i][0].format().width(10);
 		lists[i][1].format().width(25);
@@ -304,44 +824,16 @@ void Client::view_list(const std::string& board_id)
 	header[1].format().hide_border_top();
 
 	std::cout << header << std::endl;
+	engine_->metrics().record("lists.render", start);
+	// While the table is being read
+	prefetch_cards(board);
 }
 
-void Client::view_card(const std::string& list_id)
+void Client::print_cards(const std::string& list_id, const Local_Mirror::Record& list)
 {
-	if (cards_map_.size() != 0) {
-		cards_map_.clear();
-	}
-
-	// Search for trello ID using user-friendly board ID
-	auto list = lists_map_.find(list_id);
-
-	if (list == lists_map_.end()) {
-		fmt::print("View card failed. Cannot find list with ID: {}\n", list_id);
-		return;
-	}
-
-	http::response<http::string_body> res;
-
-	// Currently only need to get id, name and desciption of a card
-	auto const target = fmt::format("/1/lists/{}/cards?fields=name,desc,id&{}", list->second.trello_id, secrect_);
-	make_request(http::verb::get, target);
-
-	// Send the HTTP request to the remote host
-	http::write(stream_, req_);
-
-	// Receive the HTTP response
-	http::read(stream_, buffer_, res);
-
-	// Write the message to standard out
-	//std::cout << res << std::endl;
-
-	if (res.body().empty()) {
-		fmt::print("Wow, such empty.\n");
-		return;
-	}
-
+	auto const start = std::chrono::steady_clock::now();
 	tabulate::Table header;
-	header.add_row({ list->second.name });
+	header.add_row({ std::string(list.name) });
 	header[0][0].format()
 		.font_color(tabulate::Color::green)
 		.font_align(tabulate::FontAlign::center)
@@ -351,16 +843,16 @@ void Client::view_card(const std::string& list_id)
 	tabulate::Table cards;
 	cards.add_row({ "ID", "Name", "Description" });
 
-	nlohmann::json body = nlohmann::json::parse(res.body());
-	for (auto i = 0; i < body.size(); ++i) {
+	const auto& records = list.children;
+	for (std::size_t i = 0; i < records.size(); ++i) {
 		auto card_id = fmt::format("{}-{}", list_id, i); // Prepend the user-friendly list ID
-		auto desc = body[i].find("desc").value();
-		cards.add_row({ card_id, body[i].find("name").value(), trim_to_new_line(desc) });
-		Item card{ body[i].find("id").value() , body[i].find("name").value() };
-		cards_map_.emplace(card_id, card);
+		cards.add_row({ card_id, std::string(records[i].name), trim_to_new_line(records[i].desc) });
+	}
+	if (auto path = Item_Index::parse(list_id)) {
+		number(*path, records);
 	}
 
-	for (auto i = 0; i < body.size(); i++) {
+	for (std::size_t i = 0; i < records.size(); i++) {
 		// Force fixed size
 		cards[i][0].format().width(10);
 		cards[i][1].format().width(25);
@@ -378,84 +870,391 @@ void Client::view_card(const std::string& list_id)
 	header[1].format().hide_border_top();
 
 	std::cout << header << std::endl;
+	engine_->metrics().record("cards.render", start);
+}
+
+void Client::print_card_detail(const std::string& card_id, const Local_Mirror::Record& card)
+{
+	auto const start = std::chrono::steady_clock::now();
+	tabulate::Table header;
+	header.add_row({ fmt::format("Card Detail {}", card_id) });
+	header[0][0].format()
+		.font_color(tabulate::Color::green)
+		.font_align(tabulate::FontAlign::center)
+		.font_style({ tabulate::FontStyle::bold });
+
+	tabulate::Table card_detail;
+	card_detail.add_row({ "Name" , std::string(card.name) });
+	card_detail.add_row({ "Description", force_line_break(std::string(card.desc), 70) });
+
+	// Force fixed size
+	card_detail[0][0].format().width(85);
+	card_detail[1][0].format().width(85);
+
+	for (auto i = 0; i < 2; i++) {
+		// Force fixed size
+		card_detail[i][0].format().width(15);
+		card_detail[i][1].format().width(71);
+	}
+
+	header.add_row({ card_detail });
+	header[1].format().hide_border_top();
+
+	std::cout << header << std::endl;
+	engine_->metrics().record("card.render", start);
+}
+
+void Client::view_board(bool refresh)
+{
+	if (!refresh && resident_.is_fresh(workspace_id, fresh_for_)) {
+		print_boards();
+		return;
+	}
+
+	if (!refresh && !resident_.was_fetched(workspace_id) && !mirror_.boards().empty()) {
+		// Show what the last session saw right away and update it behind the scenes
+		print_boards();
+		refresh_in_background(boards_target(), {}, [this](std::vector<Local_Mirror::Fetched> boards) {
+			apply_boards(std::move(boards));
+		});
+		return;
+	}
+
+	auto boards = fetch_records(boards_target(), {}, "View board");
+	if (!boards) {
+		return;
+	}
+
+	apply_boards(std::move(*boards));
+	print_boards();
+}
+
+void Client::view_list(const std::string& board_id, bool refresh)
+{
+	// Search for trello ID using user-friendly board ID
+	auto board = find_item(board_id, 1);
+
+	if (board == nullptr) {
+		fmt::print("View list failed. Cannot find board with ID: {}\n", board_id);
+		return;
+	}
+
+	auto const trello_id = board->trello_id;
+	auto record = mirror_.find_board(trello_id);
+
+	resident_.touch(trello_id);
+	if (!refresh && record != nullptr && record->loaded) {
+		if (resident_.is_fresh(trello_id, fresh_for_)) {
+			// Downloaded moments ago, e.g. by the prefetcher while the boards were on screen
+			print_lists(board_id, *record);
+			return;
+		}
+
+		if (!resident_.was_fetched(trello_id)) {
+			// Show what the last session saw right away and update it behind the scenes
+			print_lists(board_id, *record);
+			sync_in_background(trello_id);
+			return;
+		}
+
+		// Seen in this session already, a delta from the actions feed is enough
+		if (sync_board(trello_id)) {
+			print_lists(board_id, *mirror_.find_board(trello_id));
+			return;
+		}
+	}
+
+	if (record != nullptr && record->last_action.empty()) {
+		// Remember where the actions feed is, so the next refresh can be a delta
+		seed_in_background(trello_id);
+	}
+
+	auto lists = fetch_records(lists_target(trello_id), { Response_Cache::Mirror_Key::Level::lists, trello_id }, "View list");
+	if (!lists) {
+		return;
+	}
+
+	apply_lists(trello_id, std::move(*lists));
+	if (auto updated = mirror_.find_board(trello_id)) {
+		print_lists(board_id, *updated);
+	}
+}
+
+void Client::view_card(const std::string& list_id, bool refresh)
+{
+	// Search for trello ID using user-friendly list ID
+	auto list = find_item(list_id, 2);
+
+	if (list == nullptr) {
+		fmt::print("View card failed. Cannot find list with ID: {}\n", list_id);
+		return;
+	}
+
+	auto const trello_id = list->trello_id;
+	auto record = mirror_.find_list(trello_id);
+	auto board = mirror_.find_list_parent(trello_id);
+	auto const board_trello_id = board != nullptr ? board->trello_id : Object_Id{};
+
+	resident_.touch(trello_id);
+	if (!refresh && record != nullptr && record->loaded && board != nullptr) {
+		if (resident_.is_fresh(trello_id, fresh_for_)) {
+			print_cards(list_id, *record);
+			return;
+		}
+
+		if (!resident_.was_fetched(trello_id)) {
+			print_cards(list_id, *record);
+			sync_in_background(board_trello_id);
+			return;
+		}
+
+		if (sync_board(board_trello_id)) {
+			if (auto updated = mirror_.find_list(trello_id)) {
+				print_cards(list_id, *updated);
+				return;
+			}
+		}
+	}
+
+	auto cards = fetch_records(cards_target(trello_id), { Response_Cache::Mirror_Key::Level::cards, trello_id }, "View card");
+	if (!cards) {
+		return;
+	}
+
+	apply_cards(trello_id, std::move(*cards));
+	if (auto updated = mirror_.find_list(trello_id)) {
+		print_cards(list_id, *updated);
+	}
 }
 
 void Client::view_card_detail(const std::string& card_id)
 {
 	// Search for trello ID using user-friendly card ID
-	auto card = cards_map_.find(card_id);
+	auto card = find_item(card_id, 3);
 
-	if (card == cards_map_.end()) {
+	if (card == nullptr) {
 		fmt::print("View card detail failed. Cannot find card with ID: {}\n", card_id);
 		return;
 	}
 
-	http::response<http::string_body> res;
+	auto const trello_id = card->trello_id;
+	auto record = mirror_.find_card(trello_id);
 
-	// Currently only need to get id, name and desciption of a card
-	auto const target = fmt::format("/1/cards/{}?fields=name,desc&{}", card->second.trello_id, secrect_);
-	make_request(http::verb::get, target);
+	if (!resident_.was_fetched(trello_id) && record != nullptr) {
+		print_card_detail(card_id, *record);
+		refresh_in_background(card_target(trello_id), { Response_Cache::Mirror_Key::Level::card, trello_id }, [this, trello_id](std::vector<Local_Mirror::Fetched> detail) {
+			apply_card(trello_id, std::move(detail));
+		});
+		return;
+	}
 
-	// Send the HTTP request to the remote host
-	http::write(stream_, req_);
+	auto detail = fetch_records(card_target(trello_id), { Response_Cache::Mirror_Key::Level::card, trello_id }, "View card detail");
+	if (!detail) {
+		return;
+	}
 
-	// Receive the HTTP response
-	http::read(stream_, buffer_, res);
+	apply_card(trello_id, std::move(*detail));
+	if (auto updated = mirror_.find_card(trello_id)) {
+		print_card_detail(card_id, *updated);
+	}
+}
 
-	// Write the message to standard out
-	//std::cout << res << std::endl;
+void Client::crawl()
+{
+	auto const start = std::chrono::steady_clock::now();
+	auto const requests_before = engine_->requests_sent();
 
-	if (res.body().empty()) {
-		fmt::print("Wow, such empty.\n");
+	auto boards = fetch_records(boards_target(), {}, "Crawl");
+	if (!boards) {
 		return;
 	}
+	mirror_.set_boards(*boards);
+	resident_.mark_fetched(workspace_id);
+
+	// The lists of a board and their open cards come in one route, up to ten boards go in one request.
+	// The engine keeps at most one request per pooled connection in flight.
+	std::vector<Object_Id> board_ids;
+	std::vector<std::string> routes;
+	for (const auto& board : mirror_.boards()) {
+		board_ids.push_back(board.trello_id);
+		routes.push_back(fmt::format("/boards/{}/lists?fields=name,pos&cards=open&card_fields=name,desc,pos", board.trello_id.to_string()));
+	}
 
-	tabulate::Table header;
-	header.add_row({ fmt::format("Card Detail {}", card_id) });
-	header[0][0].format()
-		.font_color(tabulate::Color::green)
-		.font_align(tabulate::FontAlign::center)
-		.font_style({ tabulate::FontStyle::bold });
+	Batch_Queue batch(*engine_, secrect_, "cards");
+	auto results = batch.fetch(routes);
 
-	nlohmann::json body = nlohmann::json::parse(res.body());
+	std::size_t list_count = 0;
+	std::size_t card_count = 0;
+	std::size_t failed = 0;
+	for (std::size_t i = 0; i < results.size(); ++i) {
+		if (results[i].status != 200) {
+			++failed;
+			continue;
+		}
 
-	tabulate::Table card_detail;
-	card_detail.add_row({ "Name" , body.find("name").value() });
-	card_detail.add_row({ "Description", force_line_break(body.find("desc").value(), 70) });
+		auto lists = std::move(results[i].records);
+		for (const auto& list : lists) {
+			resident_.mark_fetched(list.trello_id);
+			card_count += list.children.size();
+		}
+		list_count += lists.size();
+		resident_.mark_fetched(board_ids[i]);
+		mirror_.set_lists(board_ids[i], lists);
+	}
 
-	// Force fixed size
-	card_detail[0][0].format().width(85);
-	card_detail[1][0].format().width(85);
+	trim_resident({});
+	mirror_dirty_ = true;
+	follow_mirror();
+
+	// Number what has no IDs yet, collections the user was shown keep theirs
+	number_new(nullptr);
+	for (const auto& board : mirror_.boards()) {
+		number_new(&board);
+		for (const auto& list : board.children) {
+			number_new(&list);
+		}
+	}
+
+	auto const elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+	fmt::print("Crawled {} boards, {} lists and {} cards in {} ms using {} requests.\n",
+		board_ids.size() - failed, list_count, card_count, elapsed.count(), engine_->requests_sent() - requests_before);
+	if (failed != 0) {
+		fmt::print("{} boards could not be crawled.\n", failed);
+	}
+}
+
+void Client::search(std::string_view query)
+{
+	auto const start = std::chrono::steady_clock::now();
+	auto const matches = search_index_.search(query, 50, index_);
+	auto const elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+	if (matches.empty()) {
+		fmt::print("No card matches \"{}\" ({} cards searched in {} us).\n", query, search_index_.size(), elapsed.count());
+		return;
+	}
+
+	tabulate::Table results;
+	results.add_row({ "ID", "Name" });
+	for (const auto& match : matches) {
+		results.add_row({ match.path.to_string(), std::string(match.name) });
+	}
+
+	for (std::size_t i = 0; i <= matches.size(); i++) {
+		// Force fixed size
+		results[i][0].format().width(10);
+		results[i][1].format().width(40);
+	}
 
 	for (auto i = 0; i < 2; i++) {
+		// Center all the collumns of the first row
+		results[0][i].format()
+			.font_align(tabulate::FontAlign::center)
+			.font_style({ tabulate::FontStyle::bold });
+	}
+
+	std::cout << results << std::endl;
+	fmt::print("{} matches in {} cards, {} us.\n", matches.size(), search_index_.size(), elapsed.count());
+}
+
+void Client::find(std::string_view pattern)
+{
+	auto const start = std::chrono::steady_clock::now();
+	auto const matches = finder_.find(pattern, 20);
+	auto const elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+	if (matches.empty()) {
+		fmt::print("Nothing matches \"{}\" ({} items searched in {} us).\n", pattern, finder_.size(), elapsed.count());
+		return;
+	}
+
+	tabulate::Table results;
+	results.add_row({ "ID", "Type", "Name" });
+	for (const auto& match : matches) {
+		auto const type = match.depth == 1 ? "Board" : match.depth == 2 ? "List" : "Card";
+		// Items without an ID yet are in a collection that was not printed since they appeared
+		auto const path = index_.path_of(match.trello_id);
+		results.add_row({ path != nullptr ? path->to_string() : "-", type, std::string(match.name) });
+	}
+
+	for (std::size_t i = 0; i <= matches.size(); i++) {
 		// Force fixed size
-		card_detail[i][0].format().width(15);
-		card_detail[i][1].format().width(71);
+		results[i][0].format().width(10);
+		results[i][1].format().width(7);
+		results[i][2].format().width(40);
 	}
 
-	header.add_row({ card_detail });
-	header[1].format().hide_border_top();
+	for (auto i = 0; i < 3; i++) {
+		// Center all the collumns of the first row
+		results[0][i].format()
+			.font_align(tabulate::FontAlign::center)
+			.font_style({ tabulate::FontStyle::bold });
+	}
 
-	std::cout << header << std::endl;
+	std::cout << results << std::endl;
+	fmt::print("{} best of {} items, {} us.\n", matches.size(), finder_.size(), elapsed.count());
+}
+
+void Client::stats(bool as_json)
+{
+	if (as_json) {
+		auto const path = std::filesystem::current_path() / "Iroha.stats.json";
+		std::ofstream file(path);
+		file << engine_->metrics().to_json().dump(4) << std::endl;
+		if (!file) {
+			fmt::print("Cannot write {}.\n", path.string());
+			return;
+		}
+		fmt::print("Wrote {}.\n", path.string());
+		return;
+	}
+
+	auto const histograms = engine_->metrics().snapshot();
+	if (histograms.empty()) {
+		fmt::print("Nothing measured yet.\n");
+		return;
+	}
+
+	auto ms = [](std::chrono::microseconds us) {
+		return fmt::format("{:.1f}", us.count() / 1000.0);
+	};
+
+	tabulate::Table table;
+	table.add_row({ "Metric", "Count", "Min", "p50", "p90", "p99", "Max" });
+	for (const auto& [name, histogram] : histograms) {
+		table.add_row({ name, std::to_string(histogram.count()), ms(histogram.min()), ms(histogram.percentile(0.5)),
+			ms(histogram.percentile(0.9)), ms(histogram.percentile(0.99)), ms(histogram.max()) });
+	}
+
+	for (std::size_t i = 0; i <= histograms.size(); i++) {
+		// Force fixed size
+		table[i][0].format().width(20);
+		for (auto j = 1; j < 7; j++) {
+			table[i][j].format().width(9);
+		}
+	}
+
+	for (auto i = 0; i < 7; i++) {
+		// Center all the collumns of the first row
+		table[0][i].format()
+			.font_align(tabulate::FontAlign::center)
+			.font_style({ tabulate::FontStyle::bold });
+	}
+
+	std::cout << table << std::endl;
+	fmt::print("Times in milliseconds.\n");
 }
 
 bool Client::create_board(std::string& name)
 {
 	// Trello allows duplicated names in Board, List and Card.
 
-	http::response<http::string_body> res;
-
 	// Replace all space in name with HTML code
 	std::replace(name.begin(), name.end(), ' ', '+');
 
 	auto const target = fmt::format("/1/boards/?name={}&defaultLists=false&{}", name, secrect_);
-	make_request(http::verb::post, target);
-
-	// Send the HTTP request to the remote host
-	http::write(stream_, req_);
-
-	// Receive the HTTP response
-	http::read(stream_, buffer_, res);
+	// Send the HTTP request to the remote host and wait for the response
+	auto res = make_request(http::verb::post, target);
 
 	if (res.result() != http::status::ok) {
 		fmt::print("Create board failed: {}: {}\n", res.result_int(), res.reason().to_string());
@@ -466,7 +1265,7 @@ bool Client::create_board(std::string& name)
 	//std::cout << res << std::endl;
 
 	// Due to the response sorts the board name, so we have to make another request to get the correct ID
-	view_board();
+	view_board(true);
 
 	return true;
 }
@@ -474,26 +1273,19 @@ bool Client::create_board(std::string& name)
 bool Client::create_list(const std::string& board_id, std::string& name)
 {
 	// Find the Trello ID that the list is in
-	auto list = boards_map_.find(board_id);
+	auto list = find_item(board_id, 1);
 
-	if (list == boards_map_.end()) {
+	if (list == nullptr) {
 		fmt::print("Create list failed. Cannot find board with ID: {}\n", board_id);
 		return false;
 	}
 
-	http::response<http::string_body> res;
-
 	// Replace all space in name with HTML code
 	std::replace(name.begin(), name.end(), ' ', '+');
 
-	auto const target = fmt::format("/1/lists?name={}&idBoard={}&{}", name, list->second.trello_id, secrect_);
-	make_request(http::verb::post, target);
-
-	// Send the HTTP request to the remote host
-	http::write(stream_, req_);
-
-	// Receive the HTTP response
-	http::read(stream_, buffer_, res);
+	auto const target = fmt::format("/1/lists?name={}&idBoard={}&{}", name, list->trello_id.to_string(), secrect_);
+	// Send the HTTP request to the remote host and wait for the response
+	auto res = make_request(http::verb::post, target);
 
 	if (res.result() != http::status::ok) {
 		fmt::print("Create list failed: {}: {}\n", res.result_int(), res.reason().to_string());
@@ -503,7 +1295,7 @@ bool Client::create_list(const std::string& board_id, std::string& name)
 	// Write the message to standard out
 	//std::cout << res << std::endl;
 
-	view_list(board_id);
+	show_lists_after_change(board_id);
 
 	return true;
 }
@@ -511,26 +1303,19 @@ bool Client::create_list(const std::string& board_id, std::string& name)
 bool Client::create_card(const std::string& list_id, std::string& name)
 {
 	// Find the Trello ID of the list that the card is in
-	auto card = lists_map_.find(list_id);
+	auto card = find_item(list_id, 2);
 
-	if (card == lists_map_.end()) {
+	if (card == nullptr) {
 		fmt::print("Create card failed. Cannot find list with ID: {}\n", list_id);
 		return false;
 	}
 
-	http::response<http::string_body> res;
-
 	// Replace all space in name with HTML code
 	std::replace(name.begin(), name.end(), ' ', '+');
 
-	auto const target = fmt::format("/1/cards?name={}&idList={}&{}", name, card->second.trello_id, secrect_);
-	make_request(http::verb::post, target);
-
-	// Send the HTTP request to the remote host
-	http::write(stream_, req_);
-
-	// Receive the HTTP response
-	http::read(stream_, buffer_, res);
+	auto const target = fmt::format("/1/cards?name={}&idList={}&{}", name, card->trello_id.to_string(), secrect_);
+	// Send the HTTP request to the remote host and wait for the response
+	auto res = make_request(http::verb::post, target);
 
 	if (res.result() != http::status::ok) {
 		fmt::print("Create list failed: {}: {}\n", res.result_int(), res.reason().to_string());
@@ -540,7 +1325,7 @@ bool Client::create_card(const std::string& list_id, std::string& name)
 	// Write the message to standard out
 	//std::cout << res << std::endl;
 
-	view_card(list_id);
+	show_cards_after_change(list_id);
 
 	return true;
 }
@@ -548,26 +1333,19 @@ bool Client::create_card(const std::string& list_id, std::string& name)
 bool Client::update_board(const std::string& board_id, std::string& new_name)
 {
 	// Find the Trello ID of the board
-	auto board = boards_map_.find(board_id);
+	auto board = find_item(board_id, 1);
 
-	if (board == boards_map_.end()) {
+	if (board == nullptr) {
 		fmt::print("Update board failed. Cannot find board with ID: {}\n", board_id);
 		return false;
 	}
 
-	http::response<http::string_body> res;
-
 	// Replace all space in name with HTML code
 	std::replace(new_name.begin(), new_name.end(), ' ', '+');
 
-	auto const target = fmt::format("/1/boards/{}?name={}&{}", board->second.trello_id, new_name, secrect_);
-	make_request(http::verb::put, target);
-
-	// Send the HTTP request to the remote host
-	http::write(stream_, req_);
-
-	// Receive the HTTP response
-	http::read(stream_, buffer_, res);
+	auto const target = fmt::format("/1/boards/{}?name={}&{}", board->trello_id.to_string(), new_name, secrect_);
+	// Send the HTTP request to the remote host and wait for the response
+	auto res = make_request(http::verb::put, target);
 
 	if (res.result() != http::status::ok) {
 		fmt::print("Update board failed: {}: {}\n", res.result_int(), res.reason().to_string());
@@ -577,7 +1355,7 @@ bool Client::update_board(const std::string& board_id, std::string& new_name)
 	// Write the message to standard out
 	//std::cout << res << std::endl;
 
-	view_board();
+	view_board(true);
 
 	return true;
 }
@@ -585,26 +1363,19 @@ bool Client::update_board(const std::string& board_id, std::string& new_name)
 bool Client::update_list(const std::string& list_id, std::string& new_name)
 {
 	// Find the Trello ID of the list
-	auto list = lists_map_.find(list_id);
+	auto list = find_item(list_id, 2);
 
-	if (list == lists_map_.end()) {
+	if (list == nullptr) {
 		fmt::print("Update list failed. Cannot find list with ID: {}\n", list_id);
 		return false;
 	}
 
-	http::response<http::string_body> res;
-
 	// Replace all space in name with HTML code
 	std::replace(new_name.begin(), new_name.end(), ' ', '+');
 
-	auto const target = fmt::format("/1/lists/{}?name={}&{}", list->second.trello_id, new_name, secrect_);
-	make_request(http::verb::put, target);
-
-	// Send the HTTP request to the remote host
-	http::write(stream_, req_);
-
-	// Receive the HTTP response
-	http::read(stream_, buffer_, res);
+	auto const target = fmt::format("/1/lists/{}?name={}&{}", list->trello_id.to_string(), new_name, secrect_);
+	// Send the HTTP request to the remote host and wait for the response
+	auto res = make_request(http::verb::put, target);
 
 	if (res.result() != http::status::ok) {
 		fmt::print("Update list failed: {}: {}\n", res.result_int(), res.reason().to_string());
@@ -614,7 +1385,7 @@ bool Client::update_list(const std::string& list_id, std::string& new_name)
 	// Write the message to standard out
 	//std::cout << res << std::endl;
 
-	view_list(list_id.substr(0, 1));
+	show_lists_after_change(Item_Index::parse(list_id)->parent().to_string());
 
 	return true;
 }
@@ -622,28 +1393,21 @@ bool Client::update_list(const std::string& list_id, std::string& new_name)
 bool Client::update_card(const std::string& card_id, std::string& new_name, std::string& new_desc)
 {
 	// Find the Trello ID of the card
-	auto card = cards_map_.find(card_id);
+	auto card = find_item(card_id, 3);
 
-	if (card == cards_map_.end()) {
+	if (card == nullptr) {
 		fmt::print("Update card failed. Cannot find card with ID: {}\n", card_id);
 		return false;
 	}
 
-	http::response<http::string_body> res;
-
 	// Replace all space in name with HTML code
 	std::replace(new_name.begin(), new_name.end(), ' ', '+');
 	std::replace(new_desc.begin(), new_desc.end(), ' ', '+');
 
 
-	auto const target = fmt::format("/1/cards/{}?name={}&desc={}&{}", card->second.trello_id, new_name, new_desc, secrect_);
-	make_request(http::verb::put, target);
-
-	// Send the HTTP request to the remote host
-	http::write(stream_, req_);
-
-	// Receive the HTTP response
-	http::read(stream_, buffer_, res);
+	auto const target = fmt::format("/1/cards/{}?name={}&desc={}&{}", card->trello_id.to_string(), new_name, new_desc, secrect_);
+	// Send the HTTP request to the remote host and wait for the response
+	auto res = make_request(http::verb::put, target);
 
 	if (res.result() != http::status::ok) {
 		fmt::print("Update card failed: {}: {}\n", res.result_int(), res.reason().to_string());
@@ -653,70 +1417,67 @@ bool Client::update_card(const std::string& card_id, std::string& new_name, std:
 	// Write the message to standard out
 	//std::cout << res << std::endl;
 
-	view_card(card_id.substr(0, 3));
+	show_cards_after_change(Item_Index::parse(card_id)->parent().to_string());
 
 	return true;
 }
 
 bool Client::close(const std::string& id)
 {
-	auto count = std::count(id.begin(), id.end(), '-');
+	auto path = Item_Index::parse(id);
 	std::string target{};
 
-	if (count == 0) {
+	if (!path) {
+		fmt::print("Close failed. Invalid ID: {}\n", id);
+		return false;
+	}
+	else if (path->depth == 1) {
 		// Only board ID
-		auto board = boards_map_.find(id);
+		auto board = find_item(id, 1);
 
-		if (board == boards_map_.end()) {
+		if (board == nullptr) {
 			fmt::print("Close board failed. Cannot find board with ID: {}\n", id);
 			return false;
 		}
-		target = fmt::format("/1/boards/{}?closed=true&{}", board->second.trello_id, secrect_);
+		target = fmt::format("/1/boards/{}?closed=true&{}", board->trello_id.to_string(), secrect_);
 	}
-	else if (count == 1) {
+	else if (path->depth == 2) {
 		// List ID
-		auto list = lists_map_.find(id);
+		auto list = find_item(id, 2);
 
-		if (list == lists_map_.end()) {
+		if (list == nullptr) {
 			fmt::print("Close list failed. Cannot find list with ID: {}\n", id);
 			return false;
 		}
-		target = fmt::format("/1/lists/{}?closed=true&{}", list->second.trello_id, secrect_);
+		target = fmt::format("/1/lists/{}?closed=true&{}", list->trello_id.to_string(), secrect_);
 	}
-	else if (count == 2) {
+	else {
 		// Card ID
-		auto card = cards_map_.find(id);
+		auto card = find_item(id, 3);
 
-		if (card == cards_map_.end()) {
+		if (card == nullptr) {
 			fmt::print("Close card failed. Cannot find card with ID: {}\n", id);
 			return false;
 		}
-		target = fmt::format("/1/cards/{}?closed=true&{}", card->second.trello_id, secrect_);
+		target = fmt::format("/1/cards/{}?closed=true&{}", card->trello_id.to_string(), secrect_);
 	}
 
-	http::response<http::string_body> res;
-
-	make_request(http::verb::put, target);
-
-	// Send the HTTP request to the remote host
-	http::write(stream_, req_);
-
-	// Receive the HTTP response
-	http::read(stream_, buffer_, res);
+	// Send the HTTP request to the remote host and wait for the response
+	auto res = make_request(http::verb::put, target);
 
 	if (res.result() != http::status::ok) {
 		fmt::print("Close failed: {}: {}\n", res.result_int(), res.reason().to_string());
 		return false;
 	}
 
-	if (count == 0) {
-		view_board();
+	if (path->depth == 1) {
+		view_board(true);
 	}
-	else if (count == 1) {
-		view_list(id.substr(0, 1));
+	else if (path->depth == 2) {
+		show_lists_after_change(path->parent().to_string());
 	}
-	else if (count == 2) {
-		view_card(id.substr(0, 3));
+	else {
+		show_cards_after_change(path->parent().to_string());
 	}
 
 	return true;
@@ -734,6 +1495,9 @@ bool Client::get_user_input()
 	fmt::print("Action: ");
 	std::string input{};
 	std::getline(std::cin, input);
+
+	// Apply whatever the background refreshes fetched while the user was typing
+	drain_inbox();
 	std::vector<std::string> results;
 	split(results, input, is_space());
 
@@ -742,44 +1506,52 @@ bool Client::get_user_input()
 		return true;
 	}
 
-	if (results.front() == "view") {
-		if (results.size() != 1) {
-			if (contains(results[1], "-")) {
-				if (std::count(results[1].begin(), results[1].end(), '-') > 1) {
-					view_card_detail(results[1]);
-				}
-				else {
-					view_card(results[1]);
-				}
-			}
-			else {
-				view_list(results[1]);
-			}
+	if (results.front() == "search" || results.front() == "find") {
+		// Everything after the command is the query
+		auto const query = trim_copy(input.substr(input.find(results.front()) + results.front().size()));
+		if (query.empty()) {
+			fmt::print("Please enter something to {}.\n", results.front() == "find" ? "find" : "search for");
+		}
+		else if (results.front() == "find") {
+			find(query);
 		}
 		else {
-			view_board();
+			search(query);
 		}
+		return true;
 	}
-	else if (results.front() == "create") {
-		if (results.size() != 1) {
-			if (contains(results[1], "-")) {
-				// Create new card
-				fmt::print("New Card name:\n");
-				std::string input{};
-				std::getline(std::cin, input);
-
-				create_card(results[1], input);
-			}
-			else {
-				// Create new list
-				fmt::print("New List name:\n");
-				std::string input{};
-				std::getline(std::cin, input);
 
-				create_list(results[1], input);
-			}
+	if (results.front() == "stats") {
+		stats(results.size() > 1 && results[1] == "json");
+		return true;
+	}
+
+	// The ID argument, parsed once for every command
+	auto const path = results.size() > 1 ? Item_Index::parse(results[1]) : std::nullopt;
+	if (results.size() > 1 && !path) {
+		fmt::print("Invalid ID: {}\n", results[1]);
+		return true;
+	}
+
+	if (results.front() == "view") {
+		if (!path) {
+			view_board();
+		}
+		else if (path->depth == 1) {
+			view_list(results[1]);
+		}
+		else if (path->depth == 2) {
+			view_card(results[1]);
 		}
 		else {
+			view_card_detail(results[1]);
+		}
+	}
+	else if (results.front() == "crawl") {
+		crawl();
+	}
+	else if (results.front() == "create") {
+		if (!path) {
 			// Create new board
 			fmt::print("New Board name:\n");
 			std::string input{};
@@ -787,33 +1559,28 @@ bool Client::get_user_input()
 
 			create_board(input);
 		}
-	}
-	else if (results.front() == "update") {
-		if (results.size() != 1) {
-			if (contains(results[1], "-")) {
-				if (std::count(results[1].begin(), results[1].end(), '-') > 1) {
-					// Update card
-					fmt::print("New Card name:\n");
-					std::string name_input{};
-					std::getline(std::cin, name_input);
-
-					fmt::print("New Card description:\n");
-					std::string desc_input{};
-					std::getline(std::cin, desc_input);
-
-					update_card(results[1], name_input, desc_input);
-				}
-				else {
-					// Update list
-					fmt::print("New List name:\n");
-					std::string input{};
-					std::getline(std::cin, input);
+		else if (path->depth == 1) {
+			// Create new list
+			fmt::print("New List name:\n");
+			std::string input{};
+			std::getline(std::cin, input);
 
-					update_list(results[1], input);
-				}
-			}
+			create_list(results[1], input);
 		}
 		else {
+			// Create new card
+			fmt::print("New Card name:\n");
+			std::string input{};
+			std::getline(std::cin, input);
+
+			create_card(results[1], input);
+		}
+	}
+	else if (results.front() == "update") {
+		if (!path) {
+			fmt::print("Please enter the ID of the item.\n");
+		}
+		else if (path->depth == 1) {
 			// Update board
 			fmt::print("New Board name:\n");
 			std::string input{};
@@ -821,9 +1588,29 @@ bool Client::get_user_input()
 
 			update_board(results[1], input);
 		}
+		else if (path->depth == 2) {
+			// Update list
+			fmt::print("New List name:\n");
+			std::string input{};
+			std::getline(std::cin, input);
+
+			update_list(results[1], input);
+		}
+		else {
+			// Update card
+			fmt::print("New Card name:\n");
+			std::string name_input{};
+			std::getline(std::cin, name_input);
+
+			fmt::print("New Card description:\n");
+			std::string desc_input{};
+			std::getline(std::cin, desc_input);
+
+			update_card(results[1], name_input, desc_input);
+		}
 	}
 	else if (results.front() == "close") {
-		if (results.size() < 2) {
+		if (!path) {
 			fmt::print("Please enter the ID of the item.\n");
 		}
 		else {
@@ -1,5 +1,15 @@
 #pragma once
 #include "root_certificates.hpp"
+#include "Request_Engine.h"
+#include "Local_Mirror.h"
+#include "Sync_Engine.h"
+#include "Response_Cache.h"
+#include "Record_Decoder.h"
+#include "Batch_Queue.h"
+#include "Item_Index.h"
+#include "Residency.h"
+#include "Search_Index.h"
+#include "Fuzzy_Finder.h"
 #include <boost/beast/core.hpp>
 #include <boost/beast/http.hpp>
 #include <boost/beast/ssl.hpp>
@@ -14,36 +24,103 @@
 #include <robin-hood-hashing/robin_hood.h>
 #include "yaml-cpp/yaml.h"
 #include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <optional>
 
 class Client {
 private:
-	// Represent each item in Trello
-	// Either a board, a list or a card
-	struct Item {
-		std::string trello_id;
-		std::string name;
-	};
-	boost::asio::ip::tcp::resolver resolver_;
-	boost::beast::ssl_stream<boost::beast::tcp_stream> stream_;
+	boost::asio::io_context& ioc_;
+	ssl::context& ctx_;
 	std::string const host_{"api.trello.com"};
 	unsigned short const port_{ 443 };
 	unsigned short const version_{ 11 };
-	boost::beast::http::request<boost::beast::http::empty_body> req_;
-	boost::beast::flat_buffer buffer_;
+	Request_Engine::Options engine_options_{};
+	std::unique_ptr<Request_Engine> engine_;
 	std::string secrect_{};
-	robin_hood::unordered_map<std::string, Item> boards_map_;
-	robin_hood::unordered_map<std::string, Item> lists_map_;
-	robin_hood::unordered_map<std::string, Item> cards_map_;
+	Item_Index index_;
+	// Full text index over the mirrored cards, kept up to date by the apply functions
+	Search_Index search_index_;
+	// Fuzzy matching over the names of everything mirrored, kept up to date like search_index_
+	Fuzzy_Finder finder_;
+	Local_Mirror mirror_;
+	bool mirror_dirty_{ false };
+	// Validators of earlier GETs and where their records were mirrored, for conditional requests
+	Response_Cache responses_;
+	// When each collection was downloaded in this session and when it was last used
+	Residency resident_;
+	static inline const Object_Id workspace_id{};
+	// Collections downloaded more recently than this are shown without asking Trello
+	std::chrono::seconds fresh_for_{ 30 };
+	// Cards kept in the mirror, the cards of the least recently used lists are dropped beyond it
+	std::size_t resident_cards_{ 100000 };
+	// Guesses per screen, they fit in one /1/batch call
+	static constexpr std::size_t prefetch_limit = Batch_Queue::max_routes;
+	// Results of background requests, applied on the main thread between commands
+	std::mutex inbox_mutex_;
+	std::vector<std::function<void()>> inbox_;
 	tabulate::Table help_table_;
 
 private:
 	void make_secrect();
-	void init();
-	void make_request(boost::beast::http::verb type, const std::string& target);
-	std::string trim_to_new_line(const std::string& input);
+	bool init();
+	// Send a request through the engine and block until its response arrives
+	boost::beast::http::response<boost::beast::http::string_body> make_request(boost::beast::http::verb type, const std::string& target);
+	std::string trim_to_new_line(std::string_view input);
 	void create_help_table();
 	std::string force_line_break(const std::string& input, unsigned short num_char);
 
+	std::string boards_target() const;
+	std::string lists_target(const Object_Id& board_trello_id) const;
+	std::string cards_target(const Object_Id& list_trello_id) const;
+	std::string card_target(const Object_Id& card_trello_id) const;
+
+	// Times the decoding as "<endpoint>.parse". Returns nothing if the body is invalid or truncated.
+	std::optional<std::vector<Local_Mirror::Fetched>> parse_records(const std::string& target, const std::string& body);
+	// The records behind a response cached under key, copied from the mirror. Nothing if they are no longer mirrored.
+	std::optional<std::vector<Local_Mirror::Fetched>> mirrored(const Response_Cache::Mirror_Key& key);
+	// key says where the caller mirrors the records, a later 304 takes them from there
+	std::optional<std::vector<Local_Mirror::Fetched>> fetch_records(const std::string& target, const Response_Cache::Mirror_Key& key,
+		const std::string& action);
+	void refresh_in_background(std::string target, Response_Cache::Mirror_Key key, std::function<void(std::vector<Local_Mirror::Fetched>)> apply);
+	// Fetch the children of what is on screen, the next command usually views one of them
+	void prefetch_lists();
+	void prefetch_cards(const Local_Mirror::Record& board);
+	void post_to_main(std::function<void()> update);
+	void drain_inbox();
+
+	// Incremental updates of a mirrored board from its actions feed
+	bool apply_actions(const Object_Id& board_trello_id, const nlohmann::json& actions);
+	bool sync_board(const Object_Id& board_trello_id);
+	void sync_in_background(const Object_Id& board_trello_id);
+	void seed_in_background(const Object_Id& board_trello_id);
+	void show_lists_after_change(const std::string& board_id);
+	void show_cards_after_change(const std::string& list_id);
+
+	// Give the children of a collection the IDs they are printed with. Items that moved are numbered
+	// again with everything below them, items still at their position keep the IDs below them.
+	void number(const Item_Index::Path& parent, const std::vector<Local_Mirror::Record>& children);
+	// Number the children of a record, the boards for nullptr, unless they have IDs already.
+	// Numbered collections keep what the user saw until they are printed again.
+	void number_new(const Local_Mirror::Record* parent);
+	// Bring the fuzzy finder and the search index up to the records the mirror changed since the last call
+	void follow_mirror();
+	// Index every mirrored record again, after loading or when the string pool was replaced
+	void reindex_mirror();
+	// The item behind a user-friendly ID, if the ID has the expected depth
+	const Item_Index::Item* find_item(const std::string& id, std::uint32_t depth) const;
+	void apply_boards(std::vector<Local_Mirror::Fetched> boards);
+	void apply_lists(const Object_Id& board_trello_id, std::vector<Local_Mirror::Fetched> lists);
+	void apply_cards(const Object_Id& list_trello_id, std::vector<Local_Mirror::Fetched> cards);
+	void apply_card(const Object_Id& card_trello_id, std::vector<Local_Mirror::Fetched> card);
+	// Drop the cards of the least recently used lists until the mirror fits resident_cards_
+	void trim_resident(const Object_Id& keep_list_trello_id);
+
+	void print_boards();
+	void print_lists(const std::string& board_id, const Local_Mirror::Record& board);
+	void print_cards(const std::string& list_id, const Local_Mirror::Record& list);
+	void print_card_detail(const std::string& card_id, const Local_Mirror::Record& card);
+
 public:
 	Client(boost::asio::io_context& ioc, ssl::context& ctx);
 	~Client();
@@ -57,10 +134,20 @@ public:
 	// Move assignment
 	Client& operator=(Client&& other) noexcept;
 
-	void view_board(); // View all available board
-	void view_list(const std::string& board_id); // View lists in a particualar board
-	void view_card(const std::string& list_id); // View cards in list
+	// The first view of a collection in a session renders from the local mirror and refreshes in the background.
+	// Pass refresh to always wait for the network, e.g. after a change.
+	void view_board(bool refresh = false); // View all available board
+	void view_list(const std::string& board_id, bool refresh = false); // View lists in a particualar board
+	void view_card(const std::string& list_id, bool refresh = false); // View cards in list
 	void view_card_detail(const std::string& card_id); // view specific card detail. Will show the card's name and desc in full text
+	// Download every board with its lists and open cards, many boards per request
+	void crawl();
+	// Find mirrored cards by name and description, without asking Trello
+	void search(std::string_view query);
+	// Rank boards, lists and cards by how well their names fuzzy match the pattern
+	void find(std::string_view pattern);
+	// Latency percentiles of the network phases, parsing and rendering, or the same as JSON in a file
+	void stats(bool as_json);
 
 	bool create_board(std::string& name);
 	bool create_list(const std::string& board_id, std::string& name);
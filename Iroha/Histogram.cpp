@@ -0,0 +1,91 @@
+#include "Histogram.h"
+#include <algorithm>
+
+namespace {
+	unsigned highest_bit(std::uint64_t value)
+	{
+		unsigned bit = 0;
+		while (value >>= 1) {
+			++bit;
+		}
+		return bit;
+	}
+}
+
+std::size_t Histogram::index_of(std::uint64_t value)
+{
+	// Values below two sub-bucket ranges are counted exactly
+	if (value < 2 * sub_buckets) {
+		return static_cast<std::size_t>(value);
+	}
+
+	// Above, the bits right below the highest one pick the sub-bucket
+	auto const exponent = highest_bit(value);
+	auto const sub = (value >> (exponent - sub_bucket_bits)) & (sub_buckets - 1);
+	return static_cast<std::size_t>(2 * sub_buckets + (exponent - sub_bucket_bits - 1) * sub_buckets + sub);
+}
+
+std::uint64_t Histogram::lowest_of(std::size_t index)
+{
+	if (index < 2 * sub_buckets) {
+		return index;
+	}
+
+	auto const exponent = (index - 2 * sub_buckets) / sub_buckets + sub_bucket_bits + 1;
+	auto const sub = (index - 2 * sub_buckets) % sub_buckets;
+	return (sub_buckets + sub) << (exponent - sub_bucket_bits);
+}
+
+void Histogram::record(std::chrono::microseconds value)
+{
+	auto const micros = static_cast<std::uint64_t>(std::max<std::chrono::microseconds::rep>(value.count(), 0));
+	auto const index = index_of(micros);
+	if (index >= counts_.size()) {
+		counts_.resize(index + 1);
+	}
+
+	++counts_[index];
+	min_ = total_ == 0 ? micros : std::min(min_, micros);
+	max_ = std::max(max_, micros);
+	sum_ += static_cast<double>(micros);
+	++total_;
+}
+
+std::uint64_t Histogram::count() const
+{
+	return total_;
+}
+
+std::chrono::microseconds Histogram::min() const
+{
+	return std::chrono::microseconds(min_);
+}
+
+std::chrono::microseconds Histogram::max() const
+{
+	return std::chrono::microseconds(max_);
+}
+
+std::chrono::microseconds Histogram::mean() const
+{
+	return std::chrono::microseconds(total_ == 0 ? 0 : static_cast<std::int64_t>(sum_ / total_));
+}
+
+std::chrono::microseconds Histogram::percentile(double fraction) const
+{
+	if (total_ == 0) {
+		return std::chrono::microseconds(0);
+	}
+
+	auto const wanted = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(fraction * total_ + 0.5));
+	std::uint64_t seen = 0;
+	for (std::size_t i = 0; i < counts_.size(); ++i) {
+		seen += counts_[i];
+		if (seen >= wanted) {
+			// Report the top of the bucket, but never beyond what was actually recorded
+			auto const highest = lowest_of(i + 1) - 1;
+			return std::chrono::microseconds(std::clamp(highest, min_, max_));
+		}
+	}
+	return max();
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+// Log-linear histogram of durations in the spirit of HdrHistogram.
+// Every power of two is split into 32 linear sub-buckets, so any recorded value is
+// known to within about 3% while the whole range from a microsecond to hours takes a few KB.
+class Histogram {
+public:
+	static constexpr unsigned sub_bucket_bits = 5;
+	static constexpr std::uint64_t sub_buckets = std::uint64_t{ 1 } << sub_bucket_bits;
+
+private:
+	std::vector<std::uint64_t> counts_; // Grown on demand
+	std::uint64_t total_{ 0 };
+	std::uint64_t min_{ 0 };
+	std::uint64_t max_{ 0 };
+	double sum_{ 0 };
+
+private:
+	static std::size_t index_of(std::uint64_t value);
+	static std::uint64_t lowest_of(std::size_t index);
+
+public:
+	void record(std::chrono::microseconds value);
+
+	std::uint64_t count() const;
+	std::chrono::microseconds min() const;
+	std::chrono::microseconds max() const;
+	std::chrono::microseconds mean() const;
+	// The value below which the given fraction of the recorded values fall, e.g. 0.99
+	std::chrono::microseconds percentile(double fraction) const;
+};
@@ -0,0 +1,150 @@
+#include "Item_Index.h"
+#include <charconv>
+#include "fmt/format.h"
+
+std::uint64_t Item_Index::Path::key() const
+{
+	// depth:2 | board:22 | list:20 | card:20
+	return (static_cast<std::uint64_t>(depth) << 62)
+		| (static_cast<std::uint64_t>(board) << 40)
+		| (static_cast<std::uint64_t>(list) << 20)
+		| card;
+}
+
+Item_Index::Path Item_Index::Path::parent() const
+{
+	Path path{ *this };
+	switch (depth) {
+	case 3:
+		path.card = 0;
+		break;
+	case 2:
+		path.list = 0;
+		break;
+	default:
+		return {};
+	}
+	--path.depth;
+	return path;
+}
+
+Item_Index::Path Item_Index::Path::child(std::uint32_t position) const
+{
+	Path path{ *this };
+	switch (depth) {
+	case 0:
+		path.board = position;
+		break;
+	case 1:
+		path.list = position;
+		break;
+	case 2:
+		path.card = position;
+		break;
+	default:
+		return {};
+	}
+	++path.depth;
+	return path;
+}
+
+std::string Item_Index::Path::to_string() const
+{
+	switch (depth) {
+	case 1:
+		return fmt::format("{}", board);
+	case 2:
+		return fmt::format("{}-{}", board, list);
+	case 3:
+		return fmt::format("{}-{}-{}", board, list, card);
+	default:
+		return {};
+	}
+}
+
+std::optional<Item_Index::Path> Item_Index::parse(std::string_view id)
+{
+	Path path;
+	std::uint32_t* positions[] = { &path.board, &path.list, &path.card };
+
+	auto first = id.data();
+	auto const last = id.data() + id.size();
+	while (true) {
+		if (path.depth == 3) {
+			return std::nullopt;
+		}
+
+		// Plain decimal digits only, from_chars rejects signs and spaces
+		auto [next, ec] = std::from_chars(first, last, *positions[path.depth]);
+		if (ec != std::errc{} || next == first) {
+			return std::nullopt;
+		}
+		++path.depth;
+
+		if (next == last) {
+			break;
+		}
+		if (*next != '-') {
+			return std::nullopt;
+		}
+		first = next + 1;
+	}
+
+	if (path.board > max_board || path.list > max_position || path.card > max_position) {
+		return std::nullopt;
+	}
+	return path;
+}
+
+void Item_Index::clear()
+{
+	items_.clear();
+	paths_.clear();
+}
+
+void Item_Index::reserve(std::size_t count)
+{
+	items_.reserve(count);
+	paths_.reserve(count);
+}
+
+void Item_Index::add(const Path& path, const Object_Id& trello_id)
+{
+	items_[path.key()] = Item{ trello_id };
+	paths_[trello_id] = path;
+}
+
+void Item_Index::erase(const Path& path)
+{
+	auto it = items_.find(path.key());
+	if (it == items_.end()) {
+		return;
+	}
+
+	// The item may have been numbered somewhere else already
+	auto const trello_id = it->second.trello_id;
+	items_.erase(it);
+	auto position = paths_.find(trello_id);
+	if (position != paths_.end() && position->second.key() == path.key()) {
+		paths_.erase(position);
+	}
+
+	// Children are numbered from zero without gaps
+	if (path.depth < 3) {
+		for (std::uint32_t i = 0; items_.find(path.child(i).key()) != items_.end(); ++i) {
+			erase(path.child(i));
+		}
+	}
+}
+
+const Item_Index::Item* Item_Index::find(const Path& path) const
+{
+	auto it = items_.find(path.key());
+	return it != items_.end() ? &it->second : nullptr;
+}
+
+const Item_Index::Path* Item_Index::path_of(const Object_Id& trello_id) const
+{
+	auto it = paths_.find(trello_id);
+	return it != paths_.end() ? &it->second : nullptr;
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <robin-hood-hashing/robin_hood.h>
+#include "Object_Id.h"
+
+// Maps the user-friendly IDs ("2", "2-0", "2-0-13") to Trello items.
+// An ID is parsed once into a path of positions, which packs into a 64 bit key,
+// so a lookup hashes one integer instead of formatting and hashing a string.
+// Boards, lists and cards of every mirrored board are kept in the index at once.
+// The IDs are the positions the user was shown, they change only when a collection is numbered again.
+class Item_Index {
+public:
+	// Represent each item in Trello
+	// Either a board, a list or a card.
+	struct Item {
+		Object_Id trello_id;
+	};
+
+	// Position of an item: depth 1 is a board, 2 a list and 3 a card
+	struct Path {
+		std::uint32_t depth{ 0 };
+		std::uint32_t board{ 0 };
+		std::uint32_t list{ 0 };
+		std::uint32_t card{ 0 };
+
+		std::uint64_t key() const;
+		// The board of a list, or the list of a card
+		Path parent() const;
+		// The item at position under this one, the workspace is the default path
+		Path child(std::uint32_t position) const;
+		std::string to_string() const;
+	};
+
+	// Largest position accepted on each level
+	static constexpr std::uint32_t max_board = (1u << 22) - 1;
+	static constexpr std::uint32_t max_position = (1u << 20) - 1;
+
+private:
+	robin_hood::unordered_flat_map<std::uint64_t, Item> items_;
+	robin_hood::unordered_flat_map<Object_Id, Path, Object_Id::Hash> paths_; // Where each Trello ID is now
+
+public:
+	// Parse "B", "B-L" or "B-L-C". Returns nothing for anything else.
+	static std::optional<Path> parse(std::string_view id);
+
+	void clear();
+	void reserve(std::size_t count);
+	void add(const Path& path, const Object_Id& trello_id);
+	// Remove an item and everything numbered below it
+	void erase(const Path& path);
+	const Item* find(const Path& path) const;
+	// The position of a Trello item, or nothing if it is not in the index
+	const Path* path_of(const Object_Id& trello_id) const;
+};
@@ -0,0 +1,519 @@
+#include "Local_Mirror.h"
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <system_error>
+#include <utility>
+
+namespace bip = boost::interprocess;
+
+namespace {
+	constexpr char magic[4] = { 'I', 'R', 'H', 'M' };
+
+	// Bounds checked reader over the mapped file
+	class Reader {
+	private:
+		const char* data_;
+		std::size_t size_;
+		std::size_t offset_{ 0 };
+
+	public:
+		Reader(const char* data, std::size_t size) : data_{ data }, size_{ size } {}
+
+		bool read(void* out, std::size_t count)
+		{
+			if (size_ - offset_ < count) {
+				return false;
+			}
+			std::memcpy(out, data_ + offset_, count);
+			offset_ += count;
+			return true;
+		}
+
+		bool read(std::uint32_t& value)
+		{
+			return read(&value, sizeof(value));
+		}
+
+		bool read(double& value)
+		{
+			return read(&value, sizeof(value));
+		}
+
+		bool read(Object_Id& value)
+		{
+			return read(value.bytes.data(), value.bytes.size());
+		}
+
+		// A view into the mapped file
+		bool read(std::string_view& value)
+		{
+			std::uint32_t length{};
+			if (!read(length) || size_ - offset_ < length) {
+				return false;
+			}
+			value = { data_ + offset_, length };
+			offset_ += length;
+			return true;
+		}
+
+		bool read(std::string& value)
+		{
+			std::string_view view;
+			if (!read(view)) {
+				return false;
+			}
+			value.assign(view);
+			return true;
+		}
+	};
+
+	bool read_records(Reader& reader, String_Pool& strings, std::vector<Local_Mirror::Record>& records, int depth)
+	{
+		std::uint32_t count{};
+		if (!reader.read(count)) {
+			return false;
+		}
+
+		// Boards, lists and cards, anything deeper means the file is corrupt
+		if (count != 0 && depth > 2) {
+			return false;
+		}
+
+		records.resize(count);
+		for (auto& record : records) {
+			std::string_view name;
+			std::string_view desc;
+			std::uint32_t loaded{};
+			if (!reader.read(record.trello_id) || !reader.read(name) || !reader.read(desc)
+				|| !reader.read(record.pos) || !reader.read(record.last_action) || !reader.read(loaded)
+				|| !read_records(reader, strings, record.children, depth + 1)) {
+				return false;
+			}
+			// Copied out of the mapping, which is closed after loading
+			record.name = strings.intern(name);
+			record.desc = strings.intern(desc);
+			record.loaded = loaded != 0;
+		}
+		return true;
+	}
+
+	void write_value(std::ofstream& out, std::uint32_t value)
+	{
+		out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+	}
+
+	void write_value(std::ofstream& out, double value)
+	{
+		out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+	}
+
+	void write_value(std::ofstream& out, const Object_Id& value)
+	{
+		out.write(reinterpret_cast<const char*>(value.bytes.data()), value.bytes.size());
+	}
+
+	void write_value(std::ofstream& out, std::string_view value)
+	{
+		write_value(out, static_cast<std::uint32_t>(value.size()));
+		out.write(value.data(), value.size());
+	}
+
+	void write_records(std::ofstream& out, const std::vector<Local_Mirror::Record>& records)
+	{
+		write_value(out, static_cast<std::uint32_t>(records.size()));
+		for (const auto& record : records) {
+			write_value(out, record.trello_id);
+			write_value(out, record.name);
+			write_value(out, record.desc);
+			write_value(out, record.pos);
+			write_value(out, record.last_action);
+			write_value(out, static_cast<std::uint32_t>(record.loaded));
+			write_records(out, record.children);
+		}
+	}
+
+	// Live text of the records, shared strings are counted every time
+	std::size_t text_size(const std::vector<Local_Mirror::Record>& records)
+	{
+		std::size_t size = 0;
+		for (const auto& record : records) {
+			size += record.name.size() + record.desc.size() + text_size(record.children);
+		}
+		return size;
+	}
+
+	void reintern(std::vector<Local_Mirror::Record>& records, String_Pool& strings)
+	{
+		for (auto& record : records) {
+			record.name = strings.intern(record.name);
+			record.desc = strings.intern(record.desc);
+			reintern(record.children, strings);
+		}
+	}
+
+	void sort_by_position(std::vector<Local_Mirror::Record>& records)
+	{
+		std::stable_sort(records.begin(), records.end(), [](const Local_Mirror::Record& a, const Local_Mirror::Record& b) {
+			return a.pos < b.pos;
+		});
+	}
+
+	// Keep the children of records that survive a refresh of their level
+	void merge_children(std::vector<Local_Mirror::Record>& fresh, std::vector<Local_Mirror::Record>& old)
+	{
+		for (auto& record : fresh) {
+			auto it = std::find_if(old.begin(), old.end(), [&record](const Local_Mirror::Record& previous) {
+				return previous.trello_id == record.trello_id;
+			});
+			if (it != old.end() && !record.loaded) {
+				record.children = std::move(it->children);
+				record.loaded = it->loaded;
+				record.last_action = std::move(it->last_action);
+			}
+		}
+	}
+}
+
+Local_Mirror::Local_Mirror(std::filesystem::path path) :
+	path_{ std::move(path) }
+{
+}
+
+bool Local_Mirror::load()
+{
+	std::error_code ec;
+	if (!std::filesystem::exists(path_, ec) || std::filesystem::file_size(path_, ec) == 0) {
+		return false;
+	}
+
+	try {
+		bip::file_mapping file(path_.string().c_str(), bip::read_only);
+		bip::mapped_region region(file, bip::read_only);
+		Reader reader(static_cast<const char*>(region.get_address()), region.get_size());
+
+		char header[4]{};
+		std::uint32_t version{};
+		if (!reader.read(header, sizeof(header)) || std::memcmp(header, magic, sizeof(magic)) != 0
+			|| !reader.read(version) || version != format_version) {
+			return false;
+		}
+
+		String_Pool strings;
+		std::vector<Record> boards;
+		if (!read_records(reader, strings, boards, 0)) {
+			return false;
+		}
+		strings_ = std::move(strings);
+		boards_ = std::move(boards);
+		locations_.clear();
+		locate(boards_, {}, 1, true);
+	}
+	catch (const bip::interprocess_exception&) {
+		return false;
+	}
+	return true;
+}
+
+bool Local_Mirror::save() const
+{
+	auto temporary = path_;
+	temporary += ".tmp";
+
+	{
+		std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+		if (!out) {
+			return false;
+		}
+		out.write(magic, sizeof(magic));
+		write_value(out, format_version);
+		write_records(out, boards_);
+		if (!out) {
+			return false;
+		}
+	}
+
+	std::error_code ec;
+	std::filesystem::rename(temporary, path_, ec);
+	return !ec;
+}
+
+std::vector<Local_Mirror::Record> Local_Mirror::make_records(const std::vector<Fetched>& fetched, std::uint32_t depth)
+{
+	std::vector<Record> records;
+	records.reserve(fetched.size());
+	for (const auto& source : fetched) {
+		Record record;
+		record.trello_id = source.trello_id;
+		record.name = strings_.intern(source.name);
+		record.desc = strings_.intern(source.desc);
+		record.pos = source.pos;
+		record.loaded = source.loaded;
+		record.children = make_records(source.children, depth + 1);
+		changes_.push_back({ record.trello_id, depth });
+		records.push_back(std::move(record));
+	}
+	return records;
+}
+
+std::string_view Local_Mirror::intern(std::string_view text)
+{
+	return strings_.intern(text);
+}
+
+void Local_Mirror::set_name(Record& record, std::uint32_t depth, std::string_view name)
+{
+	auto const interned = strings_.intern(name);
+	if (interned.data() != record.name.data() || interned.size() != record.name.size()) {
+		record.name = interned;
+		changes_.push_back({ record.trello_id, depth });
+	}
+}
+
+void Local_Mirror::set_desc(Record& record, std::uint32_t depth, std::string_view desc)
+{
+	auto const interned = strings_.intern(desc);
+	if (interned.data() != record.desc.data() || interned.size() != record.desc.size()) {
+		record.desc = interned;
+		changes_.push_back({ record.trello_id, depth });
+	}
+}
+
+std::vector<Local_Mirror::Change> Local_Mirror::take_changes()
+{
+	return std::exchange(changes_, {});
+}
+
+bool Local_Mirror::compact()
+{
+	// Strings of changed and dropped records stay in the pool until now
+	if (strings_.bytes() <= 2 * text_size(boards_) + String_Pool::block_size) {
+		return false;
+	}
+
+	String_Pool strings;
+	reintern(boards_, strings);
+	strings_ = std::move(strings);
+	return true;
+}
+
+const std::vector<Local_Mirror::Record>& Local_Mirror::boards() const
+{
+	return boards_;
+}
+
+Local_Mirror::Record* Local_Mirror::find(const Object_Id& trello_id, std::uint32_t depth)
+{
+	auto it = locations_.find(trello_id);
+	if (it == locations_.end() || it->second.depth != depth) {
+		return nullptr;
+	}
+
+	auto const location = it->second;
+	auto records = &boards_;
+	if (depth > 1) {
+		auto parent = find(location.parent, depth - 1);
+		if (parent == nullptr) {
+			return nullptr;
+		}
+		records = &parent->children;
+	}
+
+	// A location left behind by a record that is gone points at something else or nowhere
+	if (location.index >= records->size() || (*records)[location.index].trello_id != trello_id) {
+		return nullptr;
+	}
+	return &(*records)[location.index];
+}
+
+void Local_Mirror::locate(const std::vector<Record>& records, const Object_Id& parent, std::uint32_t depth, bool deep)
+{
+	for (std::uint32_t i = 0; i < records.size(); ++i) {
+		locations_[records[i].trello_id] = Location{ parent, i, depth };
+		if (deep) {
+			locate(records[i].children, records[i].trello_id, depth + 1, true);
+		}
+	}
+}
+
+void Local_Mirror::locate(const std::vector<Record>& records, const std::vector<Fetched>& fetched, const Object_Id& parent, std::uint32_t depth)
+{
+	// Children merged from the old records kept their parent and their positions
+	locate(records, parent, depth, false);
+	for (std::size_t i = 0; i < records.size(); ++i) {
+		if (fetched[i].loaded) {
+			locate(records[i].children, records[i].trello_id, depth + 1, true);
+		}
+	}
+}
+
+void Local_Mirror::forget(const std::vector<Record>& records, std::uint32_t depth)
+{
+	for (const auto& record : records) {
+		if (find(record.trello_id, depth) == nullptr) {
+			locations_.erase(record.trello_id);
+			changes_.push_back({ record.trello_id, depth });
+		}
+		forget(record.children, depth + 1);
+	}
+}
+
+void Local_Mirror::sort_children(Record& parent, std::uint32_t depth)
+{
+	sort_by_position(parent.children);
+	locate(parent.children, parent.trello_id, depth + 1, false);
+}
+
+Local_Mirror::Record* Local_Mirror::find_board(const Object_Id& trello_id)
+{
+	return find(trello_id, 1);
+}
+
+Local_Mirror::Record* Local_Mirror::find_list(const Object_Id& trello_id)
+{
+	return find(trello_id, 2);
+}
+
+Local_Mirror::Record* Local_Mirror::find_card(const Object_Id& trello_id)
+{
+	return find(trello_id, 3);
+}
+
+void Local_Mirror::set_boards(const std::vector<Fetched>& boards)
+{
+	auto records = make_records(boards, 1);
+	merge_children(records, boards_);
+	// What is left in the old boards was not carried over
+	auto old = std::move(boards_);
+	boards_ = std::move(records);
+	locate(boards_, boards, {}, 1);
+	forget(old, 1);
+}
+
+void Local_Mirror::set_lists(const Object_Id& board_id, const std::vector<Fetched>& lists)
+{
+	if (auto board = find_board(board_id)) {
+		auto records = make_records(lists, 2);
+		merge_children(records, board->children);
+		auto old = std::move(board->children);
+		board->children = std::move(records);
+		board->loaded = true;
+		locate(board->children, lists, board_id, 2);
+		forget(old, 2);
+	}
+}
+
+void Local_Mirror::set_cards(const Object_Id& list_id, const std::vector<Fetched>& cards)
+{
+	if (auto list = find_list(list_id)) {
+		auto old = std::move(list->children);
+		list->children = make_records(cards, 3);
+		list->loaded = true;
+		locate(list->children, list_id, 3, false);
+		forget(old, 3);
+	}
+}
+
+Local_Mirror::Record* Local_Mirror::find_list_parent(const Object_Id& list_id)
+{
+	auto it = locations_.find(list_id);
+	return it != locations_.end() && it->second.depth == 2 && find_list(list_id) != nullptr ? find(it->second.parent, 1) : nullptr;
+}
+
+Local_Mirror::Record* Local_Mirror::find_card_parent(const Object_Id& card_id)
+{
+	auto it = locations_.find(card_id);
+	return it != locations_.end() && it->second.depth == 3 && find_card(card_id) != nullptr ? find(it->second.parent, 2) : nullptr;
+}
+
+bool Local_Mirror::insert_list(const Object_Id& board_id, Record list)
+{
+	auto board = find_board(board_id);
+	if (board == nullptr) {
+		return false;
+	}
+
+	changes_.push_back({ list.trello_id, 2 });
+	board->children.push_back(std::move(list));
+	sort_children(*board, 1);
+	return true;
+}
+
+bool Local_Mirror::insert_card(const Object_Id& list_id, Record card)
+{
+	auto list = find_list(list_id);
+	if (list == nullptr) {
+		return false;
+	}
+
+	changes_.push_back({ card.trello_id, 3 });
+	list->children.push_back(std::move(card));
+	sort_children(*list, 2);
+	return true;
+}
+
+void Local_Mirror::reposition(const Object_Id& trello_id)
+{
+	auto it = locations_.find(trello_id);
+	if (it == locations_.end() || it->second.depth < 2 || find(trello_id, it->second.depth) == nullptr) {
+		return;
+	}
+
+	auto const depth = it->second.depth - 1;
+	if (auto parent = find(it->second.parent, depth)) {
+		sort_children(*parent, depth);
+	}
+}
+
+bool Local_Mirror::remove_list(const Object_Id& list_id)
+{
+	auto board = find_list_parent(list_id);
+	if (board == nullptr) {
+		return false;
+	}
+
+	auto& lists = board->children;
+	auto it = std::find_if(lists.begin(), lists.end(), [&list_id](const Record& list) {
+		return list.trello_id == list_id;
+	});
+	std::vector<Record> removed;
+	removed.push_back(std::move(*it));
+	lists.erase(it);
+	locate(lists, board->trello_id, 2, false);
+	forget(removed, 2);
+	return true;
+}
+
+bool Local_Mirror::remove_card(const Object_Id& card_id)
+{
+	auto list = find_card_parent(card_id);
+	if (list == nullptr) {
+		return false;
+	}
+
+	// A copy, card_id may refer into the children being erased
+	auto const removed = card_id;
+	auto& cards = list->children;
+	cards.erase(std::remove_if(cards.begin(), cards.end(), [&removed](const Record& card) {
+		return card.trello_id == removed;
+	}), cards.end());
+	locate(cards, list->trello_id, 3, false);
+	locations_.erase(removed);
+	changes_.push_back({ removed, 3 });
+	return true;
+}
+
+void Local_Mirror::unload_cards(const Object_Id& list_id)
+{
+	auto list = find_list(list_id);
+	if (list == nullptr) {
+		return;
+	}
+
+	auto old = std::move(list->children);
+	list->children = {};
+	list->loaded = false;
+	forget(old, 3);
+}
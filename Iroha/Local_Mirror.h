@@ -0,0 +1,127 @@
+#pragma once
+#include "Object_Id.h"
+#include "String_Pool.h"
+#include <cstdint>
+#include <filesystem>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <robin-hood-hashing/robin_hood.h>
+
+// Persistent copy of the boards, lists and cards seen so far, so the next start
+// can render without waiting for the network.
+//
+// The file is a versioned binary tree, read through a memory mapping:
+//   header: "IRHM", uint32 version, uint32 board count
+//   record: 12 byte id, uint32 length + name, uint32 length + desc, double pos,
+//           uint32 length + last action, uint32 loaded, uint32 child count, children
+// Integers are stored in host byte order, the file is a local cache and not meant to be shared.
+class Local_Mirror {
+public:
+	static constexpr std::uint32_t format_version = 3;
+
+	// A board, a list or a card as it was downloaded, before its text is interned into the mirror
+	struct Fetched {
+		Object_Id trello_id;
+		std::string name;
+		std::string desc;
+		double pos{ 0 };
+		bool loaded{ false }; // The children were downloaded with it
+		std::vector<Fetched> children;
+	};
+
+	// A board, a list or a card. Children are the lists of a board or the cards of a list, in Trello's order.
+	// The name and description live in the mirror's string pool.
+	struct Record {
+		Object_Id trello_id;
+		std::string_view name;
+		std::string_view desc;
+		double pos{ 0 };
+		std::string last_action; // Boards only, newest action applied from the actions feed
+		bool loaded{ false }; // The children were downloaded at least once
+		std::vector<Record> children;
+	};
+
+public:
+	// A record that was added, renamed or dropped. Depth 1 is a board, 2 a list and 3 a card.
+	struct Change {
+		Object_Id trello_id;
+		std::uint32_t depth{ 0 };
+	};
+
+private:
+	// Where a record sits: the record holding it, the zero ID for boards, and its position among
+	// the children. Depth 1 is a board, 2 a list and 3 a card.
+	struct Location {
+		Object_Id parent;
+		std::uint32_t index{ 0 };
+		std::uint32_t depth{ 0 };
+	};
+
+	std::filesystem::path path_;
+	String_Pool strings_;
+	std::vector<Record> boards_;
+	// Every mirrored record by Trello ID, so a lookup walks up at most two parents instead of the tree
+	robin_hood::unordered_flat_map<Object_Id, Location, Object_Id::Hash> locations_;
+	std::vector<Change> changes_;
+
+private:
+	// Intern the text of downloaded records
+	std::vector<Record> make_records(const std::vector<Fetched>& fetched, std::uint32_t depth);
+	// Record the positions of one level of children after it was replaced, sorted or shortened.
+	// Deep also records everything below them.
+	void locate(const std::vector<Record>& records, const Object_Id& parent, std::uint32_t depth, bool deep);
+	// Locate a replaced level, and below it the children that were downloaded with it
+	void locate(const std::vector<Record>& records, const std::vector<Fetched>& fetched, const Object_Id& parent, std::uint32_t depth);
+	// Drop the locations of records taken out of the tree, unless they are mirrored elsewhere now
+	void forget(const std::vector<Record>& records, std::uint32_t depth);
+	// Put the children of a record back in position order and locate them again
+	void sort_children(Record& parent, std::uint32_t depth);
+
+public:
+	explicit Local_Mirror(std::filesystem::path path);
+
+	// Read the file if it exists and matches the current format. Returns false otherwise.
+	bool load();
+	// Write the whole tree to a temporary file and move it over the old one
+	bool save() const;
+
+	// Text for a record. Equal strings are stored once, the view is valid until compact() returns true.
+	std::string_view intern(std::string_view text);
+	// Change the text of a mirrored record, depth as for find()
+	void set_name(Record& record, std::uint32_t depth, std::string_view name);
+	void set_desc(Record& record, std::uint32_t depth, std::string_view desc);
+	// The records added, renamed or dropped since the last call, oldest first, so indexes over the mirror
+	// can follow without walking the tree. A record may be listed more than once, look it up for what it is now.
+	std::vector<Change> take_changes();
+	// Copy the text of the mirrored records into a new pool if most of the old one belongs to records that are gone.
+	// Returns true if it did, every name and description seen before is invalid then.
+	bool compact();
+
+	const std::vector<Record>& boards() const;
+	// A board, a list or a card by depth
+	Record* find(const Object_Id& trello_id, std::uint32_t depth);
+	Record* find_board(const Object_Id& trello_id);
+	Record* find_list(const Object_Id& trello_id);
+	Record* find_card(const Object_Id& trello_id);
+	// The board holding a list, and the list holding a card
+	Record* find_list_parent(const Object_Id& list_id);
+	Record* find_card_parent(const Object_Id& card_id);
+
+	// Replace one level of the tree. Children of records that are still present are kept.
+	void set_boards(const std::vector<Fetched>& boards);
+	void set_lists(const Object_Id& board_id, const std::vector<Fetched>& lists);
+	void set_cards(const Object_Id& list_id, const std::vector<Fetched>& cards);
+
+	// Add a record to its parent in position order. Returns false if the parent is not mirrored.
+	bool insert_list(const Object_Id& board_id, Record list);
+	bool insert_card(const Object_Id& list_id, Record card);
+	// Move a record whose pos changed to its place among its siblings
+	void reposition(const Object_Id& trello_id);
+	// Remove a record and its children. Returns false if it was not mirrored.
+	bool remove_list(const Object_Id& list_id);
+	bool remove_card(const Object_Id& card_id);
+	// Drop the cards of a list, it counts as not downloaded afterwards
+	void unload_cards(const Object_Id& list_id);
+};
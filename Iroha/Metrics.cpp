@@ -0,0 +1,67 @@
+#include "Metrics.h"
+
+namespace http = boost::beast::http;
+
+std::string Metrics::endpoint(http::verb method, boost::beast::string_view target)
+{
+	if (method != http::verb::get) {
+		return "mutation";
+	}
+
+	auto const path = target.substr(0, target.find('?'));
+	if (path == "/1/batch") {
+		return "batch";
+	}
+	if (path.starts_with("/1/members/")) {
+		return "boards";
+	}
+	if (path.ends_with("/actions")) {
+		return "actions";
+	}
+	if (path.ends_with("/lists")) {
+		return "lists";
+	}
+	if (path.ends_with("/cards")) {
+		return "cards";
+	}
+	if (path.starts_with("/1/cards/")) {
+		return "card";
+	}
+	return "other";
+}
+
+void Metrics::record(const std::string& name, clock::duration elapsed)
+{
+	auto const micros = std::chrono::duration_cast<std::chrono::microseconds>(elapsed);
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	histograms_[name].record(micros);
+}
+
+void Metrics::record(const std::string& name, clock::time_point start)
+{
+	record(name, clock::now() - start);
+}
+
+std::map<std::string, Histogram> Metrics::snapshot() const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return histograms_;
+}
+
+nlohmann::json Metrics::to_json() const
+{
+	auto json = nlohmann::json::object();
+	for (const auto& [name, histogram] : snapshot()) {
+		json[name] = {
+			{ "count", histogram.count() },
+			{ "min_us", histogram.min().count() },
+			{ "mean_us", histogram.mean().count() },
+			{ "p50_us", histogram.percentile(0.50).count() },
+			{ "p90_us", histogram.percentile(0.90).count() },
+			{ "p99_us", histogram.percentile(0.99).count() },
+			{ "max_us", histogram.max().count() }
+		};
+	}
+	return json;
+}
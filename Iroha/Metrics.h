@@ -0,0 +1,31 @@
+#pragma once
+#include "Histogram.h"
+#include <boost/beast/http/verb.hpp>
+#include <boost/beast/core/string.hpp>
+#include <map>
+#include <mutex>
+#include <string>
+#include <nlohmann/json.hpp>
+
+// Latency histograms by name, such as "lists.server" or "tls".
+// Names are "<endpoint>.<phase>" for requests and plain phase names for connection setup.
+// Recorded from the io thread and the main thread.
+class Metrics {
+public:
+	using clock = std::chrono::steady_clock;
+
+private:
+	mutable std::mutex mutex_;
+	std::map<std::string, Histogram> histograms_;
+
+public:
+	// Group a request by what it does: boards, lists, cards, card, actions, batch, mutation or other
+	static std::string endpoint(boost::beast::http::verb method, boost::beast::string_view target);
+
+	void record(const std::string& name, clock::duration elapsed);
+	void record(const std::string& name, clock::time_point start);
+
+	std::map<std::string, Histogram> snapshot() const;
+	// Count, min, mean, p50, p90, p99 and max in microseconds for every histogram
+	nlohmann::json to_json() const;
+};
@@ -0,0 +1,64 @@
+#include "Object_Id.h"
+#include <limits>
+#include <robin-hood-hashing/robin_hood.h>
+
+namespace {
+	int hex_value(char c)
+	{
+		if (c >= '0' && c <= '9') {
+			return c - '0';
+		}
+		if (c >= 'a' && c <= 'f') {
+			return c - 'a' + 10;
+		}
+		if (c >= 'A' && c <= 'F') {
+			return c - 'A' + 10;
+		}
+		return -1;
+	}
+}
+
+std::optional<Object_Id> Object_Id::parse(std::string_view hex)
+{
+	Object_Id id;
+	if (hex.size() != id.bytes.size() * 2) {
+		return std::nullopt;
+	}
+
+	for (std::size_t i = 0; i < id.bytes.size(); ++i) {
+		auto const high = hex_value(hex[2 * i]);
+		auto const low = hex_value(hex[2 * i + 1]);
+		if (high < 0 || low < 0) {
+			return std::nullopt;
+		}
+		id.bytes[i] = static_cast<std::uint8_t>(high << 4 | low);
+	}
+	return id;
+}
+
+std::string Object_Id::to_string() const
+{
+	constexpr char digits[] = "0123456789abcdef";
+
+	std::string hex(bytes.size() * 2, '0');
+	for (std::size_t i = 0; i < bytes.size(); ++i) {
+		hex[2 * i] = digits[bytes[i] >> 4];
+		hex[2 * i + 1] = digits[bytes[i] & 0x0f];
+	}
+	return hex;
+}
+
+bool Object_Id::operator==(const Object_Id& other) const
+{
+	return bytes == other.bytes;
+}
+
+bool Object_Id::operator!=(const Object_Id& other) const
+{
+	return bytes != other.bytes;
+}
+
+std::size_t Object_Id::Hash::operator()(const Object_Id& id) const
+{
+	return robin_hood::hash_bytes(id.bytes.data(), id.bytes.size());
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+// A Trello ID, the 24 hex digits of a MongoDB ObjectId, kept as its 12 raw bytes
+struct Object_Id {
+	// For hash maps keyed by Trello ID
+	struct Hash {
+		std::size_t operator()(const Object_Id& id) const;
+	};
+
+	std::array<std::uint8_t, 12> bytes{};
+
+	// Returns nothing unless the text is exactly 24 hex digits
+	static std::optional<Object_Id> parse(std::string_view hex);
+	// Lower case hex, as Trello prints it
+	std::string to_string() const;
+
+	bool operator==(const Object_Id& other) const;
+	bool operator!=(const Object_Id& other) const;
+};
@@ -0,0 +1,167 @@
+#include "Rate_Limiter.h"
+#include <boost/asio/post.hpp>
+#include <algorithm>
+#include <string>
+
+namespace beast = boost::beast;
+namespace http = beast::http;
+namespace net = boost::asio;
+
+namespace {
+	// Trello's documented limits
+	constexpr double requests_per_token = 100;
+	constexpr double requests_per_key = 300;
+	constexpr auto limit_interval = std::chrono::milliseconds(10000);
+
+	// Read a numeric header, or return -1 when it is missing or malformed
+	double header_value(const http::fields& headers, beast::string_view name)
+	{
+		auto it = headers.find(name);
+		if (it == headers.end()) {
+			return -1;
+		}
+
+		try {
+			return std::stod(std::string(it->value()));
+		}
+		catch (const std::exception&) {
+			return -1;
+		}
+	}
+}
+
+void Rate_Limiter::Bucket::configure(double limit, std::chrono::milliseconds interval)
+{
+	// Allow a tenth of the limit as burst and refill the rest evenly over the interval,
+	// so even a full burst followed by a steady flow stays under the limit
+	capacity = std::max(1.0, limit / 10);
+	rate = std::max(limit - capacity, 1.0) / std::chrono::duration<double>(interval).count();
+	tokens = std::min(tokens, capacity);
+}
+
+void Rate_Limiter::Bucket::refill(double seconds)
+{
+	tokens = std::min(capacity, tokens + seconds * rate);
+}
+
+double Rate_Limiter::Bucket::wait_time(double count) const
+{
+	return tokens >= count ? 0 : (count - tokens) / rate;
+}
+
+Rate_Limiter::Rate_Limiter(net::io_context& ioc) :
+	ioc_{ ioc },
+	timer_{ ioc }
+{
+	token_bucket_.configure(requests_per_token, limit_interval);
+	token_bucket_.tokens = token_bucket_.capacity;
+	key_bucket_.configure(requests_per_key, limit_interval);
+	key_bucket_.tokens = key_bucket_.capacity;
+}
+
+void Rate_Limiter::refill()
+{
+	auto const now = std::chrono::steady_clock::now();
+	auto const elapsed = std::chrono::duration<double>(now - last_refill_).count();
+	last_refill_ = now;
+
+	token_bucket_.refill(elapsed);
+	key_bucket_.refill(elapsed);
+}
+
+void Rate_Limiter::async_acquire(std::size_t count, std::function<void()> handler)
+{
+	if (closed_) {
+		net::post(ioc_, std::move(handler));
+		return;
+	}
+
+	// A request can never need more than a full bucket
+	auto const needed = std::min({ static_cast<double>(count), token_bucket_.capacity, key_bucket_.capacity });
+	waiters_.push_back({ needed, std::move(handler) });
+
+	// Otherwise the timer is already waiting for the front waiter
+	if (waiters_.size() == 1) {
+		serve();
+	}
+}
+
+void Rate_Limiter::serve()
+{
+	refill();
+
+	while (!waiters_.empty()) {
+		auto& waiter = waiters_.front();
+		auto const wait = std::max(token_bucket_.wait_time(waiter.count), key_bucket_.wait_time(waiter.count));
+
+		if (wait > 0) {
+			timer_.expires_after(std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(wait)));
+			timer_.async_wait([this](beast::error_code ec) {
+				if (!ec) {
+					serve();
+				}
+			});
+			return;
+		}
+
+		token_bucket_.tokens -= waiter.count;
+		key_bucket_.tokens -= waiter.count;
+		net::post(ioc_, std::move(waiter.handler));
+		waiters_.pop_front();
+	}
+}
+
+bool Rate_Limiter::try_acquire(std::size_t count)
+{
+	if (closed_ || !waiters_.empty()) {
+		return false;
+	}
+
+	refill();
+	auto const needed = static_cast<double>(count);
+	if (token_bucket_.tokens < needed + token_bucket_.capacity / 2 || key_bucket_.tokens < needed + key_bucket_.capacity / 2) {
+		return false;
+	}
+
+	token_bucket_.tokens -= needed;
+	key_bucket_.tokens -= needed;
+	return true;
+}
+
+void Rate_Limiter::update(const http::fields& headers)
+{
+	auto adapt = [&headers](Bucket& bucket, beast::string_view max, beast::string_view interval, beast::string_view remaining) {
+		auto const limit = header_value(headers, max);
+		auto const interval_ms = header_value(headers, interval);
+		if (limit > 0 && interval_ms > 0) {
+			bucket.configure(limit, std::chrono::milliseconds(static_cast<long long>(interval_ms)));
+		}
+
+		// Other clients may share the token, trust the server's count when it is lower
+		auto const left = header_value(headers, remaining);
+		if (left >= 0) {
+			bucket.tokens = std::min(bucket.tokens, left);
+		}
+	};
+
+	refill();
+	adapt(token_bucket_, "x-rate-limit-api-token-max", "x-rate-limit-api-token-interval-ms", "x-rate-limit-api-token-remaining");
+	adapt(key_bucket_, "x-rate-limit-api-key-max", "x-rate-limit-api-key-interval-ms", "x-rate-limit-api-key-remaining");
+}
+
+void Rate_Limiter::throttle()
+{
+	refill();
+	token_bucket_.tokens = std::min(token_bucket_.tokens, 0.0);
+	key_bucket_.tokens = std::min(key_bucket_.tokens, 0.0);
+}
+
+void Rate_Limiter::close()
+{
+	closed_ = true;
+	timer_.cancel();
+	for (auto& waiter : waiters_) {
+		net::post(ioc_, std::move(waiter.handler));
+	}
+	waiters_.clear();
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/beast/http/fields.hpp>
+#include <chrono>
+#include <deque>
+#include <functional>
+
+// Paces requests so they stay within Trello's rate limits:
+// 100 requests per 10 seconds per token and 300 per 10 seconds per key.
+// Each limit is a token bucket with a small burst allowance and a refill rate chosen so that
+// no 10 second window can exceed the limit, which keeps a steady flow instead of burst-then-stall.
+// Every member function must be called from the thread running the io_context.
+class Rate_Limiter {
+private:
+	struct Bucket {
+		double capacity{ 1 };
+		double tokens{ 1 };
+		double rate{ 1 }; // Tokens per second
+
+		void configure(double limit, std::chrono::milliseconds interval);
+		void refill(double seconds);
+		double wait_time(double count) const; // Seconds until count tokens are available
+	};
+
+	struct Waiter {
+		double count;
+		std::function<void()> handler;
+	};
+
+	boost::asio::io_context& ioc_;
+	boost::asio::steady_timer timer_;
+	Bucket token_bucket_;
+	Bucket key_bucket_;
+	std::chrono::steady_clock::time_point last_refill_{ std::chrono::steady_clock::now() };
+	std::deque<Waiter> waiters_;
+	bool closed_{ false };
+
+private:
+	void refill();
+	void serve();
+
+public:
+	explicit Rate_Limiter(boost::asio::io_context& ioc);
+
+	// Invoke the handler once count requests may be sent. Waiters are served in order.
+	void async_acquire(std::size_t count, std::function<void()> handler);
+
+	// Take count tokens right away, but only if nobody is waiting and half of each burst
+	// allowance would still be left afterwards. Used for speculative requests.
+	bool try_acquire(std::size_t count);
+
+	// Adapt to the x-rate-limit-api-{token,key}-* headers of a response
+	void update(const boost::beast::http::fields& headers);
+
+	// The server answered 429, stop sending until the buckets refill
+	void throttle();
+
+	// Stop pacing, pending and future waiters are released immediately
+	void close();
+};
@@ -0,0 +1,221 @@
+#include "Record_Decoder.h"
+#include <algorithm>
+#include <cctype>
+
+Record_Decoder::Record_Decoder(const char* children_key, bool batch) :
+	children_key_{ children_key },
+	batch_{ batch },
+	// A plain body starts right away, a batch body with the array of routes
+	field_{ batch ? Field::none : Field::body }
+{
+}
+
+std::optional<std::vector<Local_Mirror::Fetched>> Record_Decoder::decode(const std::string& body, const char* children_key)
+{
+	Record_Decoder decoder(children_key, false);
+	if (!nlohmann::json::sax_parse(body, &decoder)) {
+		return std::nullopt;
+	}
+	return std::move(decoder.records_);
+}
+
+std::optional<std::vector<Record_Decoder::Route>> Record_Decoder::decode_batch(const std::string& body, const char* children_key)
+{
+	Record_Decoder decoder(children_key, true);
+	if (!nlohmann::json::sax_parse(body, &decoder)) {
+		return std::nullopt;
+	}
+	return std::move(decoder.routes_);
+}
+
+Local_Mirror::Fetched* Record_Decoder::record()
+{
+	if (depth_ == record_depth_) {
+		return &current_;
+	}
+	if (in_children_ && depth_ == record_depth_ + 2) {
+		return &child_;
+	}
+	return nullptr;
+}
+
+bool Record_Decoder::value(double number)
+{
+	if (field_ == Field::status) {
+		status_ = static_cast<unsigned>(number);
+	}
+	else if (field_ == Field::pos) {
+		record()->pos = number;
+	}
+	field_ = Field::none;
+	return true;
+}
+
+bool Record_Decoder::open(bool array)
+{
+	// The first container of a body decides the layout: an array of records or a single record
+	if (field_ == Field::body) {
+		record_depth_ = depth_ + (array ? 2 : 1);
+	}
+	else if (field_ == Field::children && array) {
+		in_children_ = true;
+		current_.loaded = true;
+	}
+	++depth_;
+	field_ = Field::none;
+	return true;
+}
+
+bool Record_Decoder::close()
+{
+	--depth_;
+	field_ = Field::none;
+	return true;
+}
+
+bool Record_Decoder::null()
+{
+	field_ = Field::none;
+	return true;
+}
+
+bool Record_Decoder::boolean(bool)
+{
+	field_ = Field::none;
+	return true;
+}
+
+bool Record_Decoder::number_integer(number_integer_t val)
+{
+	return value(static_cast<double>(val));
+}
+
+bool Record_Decoder::number_unsigned(number_unsigned_t val)
+{
+	return value(static_cast<double>(val));
+}
+
+bool Record_Decoder::number_float(number_float_t val, const string_t&)
+{
+	return value(val);
+}
+
+bool Record_Decoder::string(string_t& val)
+{
+	if (auto target = record()) {
+		switch (field_) {
+		case Field::id:
+			target->trello_id = Object_Id::parse(val).value_or(Object_Id{});
+			break;
+		case Field::name:
+			target->name = std::move(val);
+			break;
+		case Field::desc:
+			target->desc = std::move(val);
+			break;
+		default:
+			break;
+		}
+	}
+	field_ = Field::none;
+	return true;
+}
+
+bool Record_Decoder::binary(binary_t&)
+{
+	field_ = Field::none;
+	return true;
+}
+
+bool Record_Decoder::start_object(std::size_t)
+{
+	open(false);
+	if (depth_ == record_depth_) {
+		current_ = {};
+	}
+	else if (in_children_ && depth_ == record_depth_ + 2) {
+		child_ = {};
+	}
+	return true;
+}
+
+bool Record_Decoder::key(string_t& val)
+{
+	if (batch_ && depth_ == 2) {
+		// Each route is either {"200": body} or an error object
+		if (!val.empty() && val.size() <= 3 && std::all_of(val.begin(), val.end(), [](unsigned char c) { return std::isdigit(c) != 0; })) {
+			status_ = static_cast<unsigned>(std::stoul(val));
+			field_ = Field::body;
+		}
+		else {
+			field_ = val == "statusCode" ? Field::status : Field::none;
+		}
+		return true;
+	}
+
+	if (record() == nullptr) {
+		return true;
+	}
+
+	if (val == "id") {
+		field_ = Field::id;
+	}
+	else if (val == "name") {
+		field_ = Field::name;
+	}
+	else if (val == "desc") {
+		field_ = Field::desc;
+	}
+	else if (val == "pos") {
+		field_ = Field::pos;
+	}
+	else if (children_key_ != nullptr && depth_ == record_depth_ && val == children_key_) {
+		field_ = Field::children;
+	}
+	else {
+		field_ = Field::none;
+	}
+	return true;
+}
+
+bool Record_Decoder::end_object()
+{
+	// A record whose ID did not parse still has the zero ID
+	if (depth_ == record_depth_) {
+		if (current_.trello_id != Object_Id{}) {
+			records_.push_back(std::move(current_));
+		}
+	}
+	else if (in_children_ && depth_ == record_depth_ + 2) {
+		if (child_.trello_id != Object_Id{}) {
+			current_.children.push_back(std::move(child_));
+		}
+	}
+	else if (batch_ && depth_ == 2) {
+		// The end of a route, the next one starts over
+		routes_.push_back({ status_, std::move(records_) });
+		records_.clear();
+		status_ = 0;
+		record_depth_ = 0;
+	}
+	return close();
+}
+
+bool Record_Decoder::start_array(std::size_t)
+{
+	return open(true);
+}
+
+bool Record_Decoder::end_array()
+{
+	if (in_children_ && depth_ == record_depth_ + 1) {
+		in_children_ = false;
+	}
+	return close();
+}
+
+bool Record_Decoder::parse_error(std::size_t, const std::string&, const nlohmann::detail::exception&)
+{
+	records_.clear();
+	return false;
+}
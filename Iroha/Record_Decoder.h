@@ -0,0 +1,65 @@
+#pragma once
+#include "Local_Mirror.h"
+#include <nlohmann/json.hpp>
+#include <optional>
+
+// SAX handler that reads the id, name, desc and pos of Trello objects straight into records,
+// without building a JSON document. Accepts an array of objects (boards, lists, cards)
+// or a single object (one card). Everything else in the objects is skipped,
+// and objects without a valid Trello ID are dropped.
+// A /1/batch response is read the same way, one route after another.
+class Record_Decoder : public nlohmann::json_sax<nlohmann::json> {
+public:
+	// One route of a /1/batch response
+	struct Route {
+		unsigned status{ 0 };
+		std::vector<Local_Mirror::Fetched> records;
+	};
+
+private:
+	enum class Field { none, id, name, desc, pos, children, status, body };
+
+	const char* children_key_;
+	bool batch_;
+	std::vector<Route> routes_;
+	std::vector<Local_Mirror::Fetched> records_;
+	Local_Mirror::Fetched current_;
+	Local_Mirror::Fetched child_;
+	unsigned status_{ 0 };
+	std::size_t depth_{ 0 };
+	std::size_t record_depth_{ 0 }; // Depth of the record objects, known after the first container of a body
+	bool in_children_{ false };
+	Field field_{ Field::body };
+
+private:
+	Record_Decoder(const char* children_key, bool batch);
+
+	// The record whose fields are read at the current depth, if any
+	Local_Mirror::Fetched* record();
+	bool value(double number);
+	bool open(bool array);
+	bool close();
+
+public:
+	// Parse a whole response body. Returns nothing if the body is not valid JSON or is truncated,
+	// so a failed parse is not mistaken for an empty collection.
+	// children_key names a nested array that becomes the children, like the cards of lists.
+	static std::optional<std::vector<Local_Mirror::Fetched>> decode(const std::string& body, const char* children_key = nullptr);
+	// Parse a /1/batch response: an array with {"200": body} or an error object carrying "statusCode" per route.
+	// Returns nothing if the body is not valid JSON or is truncated.
+	static std::optional<std::vector<Route>> decode_batch(const std::string& body, const char* children_key = nullptr);
+
+	bool null() override;
+	bool boolean(bool val) override;
+	bool number_integer(number_integer_t val) override;
+	bool number_unsigned(number_unsigned_t val) override;
+	bool number_float(number_float_t val, const string_t& s) override;
+	bool string(string_t& val) override;
+	bool binary(binary_t& val) override;
+	bool start_object(std::size_t elements) override;
+	bool key(string_t& val) override;
+	bool end_object() override;
+	bool start_array(std::size_t elements) override;
+	bool end_array() override;
+	bool parse_error(std::size_t position, const std::string& last_token, const nlohmann::detail::exception& ex) override;
+};
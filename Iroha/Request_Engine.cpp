@@ -0,0 +1,401 @@
+#include "Request_Engine.h"
+#include <boost/beast/version.hpp>
+#include <algorithm>
+#include <future>
+#include <iterator>
+#include "fmt/format.h"
+
+namespace beast = boost::beast;
+namespace http = beast::http;
+namespace net = boost::asio;
+namespace ssl = boost::asio::ssl;
+
+Request_Engine::Request_Engine(net::io_context& ioc, ssl::context& ctx, std::string host, unsigned short port, unsigned short version,
+	Options options) :
+	ioc_{ ioc },
+	ctx_{ ctx },
+	work_{ net::make_work_guard(ioc) },
+	host_{ std::move(host) },
+	port_{ port },
+	version_{ version },
+	options_{ options },
+	limiter_{ ioc },
+	background_timer_{ ioc }
+{
+}
+
+Request_Engine::~Request_Engine()
+{
+	stop();
+}
+
+Connection::request_type Request_Engine::make_message(http::verb type, const std::string& target, const header_list& headers) const
+{
+	Connection::request_type req;
+	req.version(version_);
+	req.method(type);
+	req.target(target);
+	req.set(http::field::host, host_);
+	req.set(http::field::user_agent, BOOST_BEAST_VERSION_STRING);
+	for (const auto& [field, value] : headers) {
+		req.set(field, value);
+	}
+	return req;
+}
+
+bool Request_Engine::start()
+{
+	thread_ = std::thread([this]() { ioc_.run(); });
+
+	std::promise<std::size_t> promise;
+	auto future = promise.get_future();
+
+	net::post(ioc_, [this, &promise]() {
+		pool_ = std::make_unique<Connection_Pool>(ioc_, ctx_, bodies_, metrics_, host_, port_, options_.connections, options_.idle_timeout);
+		pool_->async_warm_up([this, &promise](std::size_t opened) {
+			promise.set_value(opened);
+			dispatch();
+		});
+	});
+
+	if (future.get() == 0) {
+		fmt::print("Cannot connect to {}.\n", host_);
+		return false;
+	}
+	return true;
+}
+
+namespace {
+	// Errors that mean the server dropped an idle keep-alive connection
+	bool is_stale_connection(const beast::error_code& ec)
+	{
+		return ec == http::error::end_of_stream
+			|| ec == net::error::eof
+			|| ec == net::error::connection_reset
+			|| ec == net::error::connection_aborted
+			|| ec == net::error::broken_pipe
+			|| ec == net::ssl::error::stream_truncated;
+	}
+
+	// Turn a transport failure into a response the callers can report
+	Request_Engine::response_type make_failure(const beast::error_code& ec)
+	{
+		Request_Engine::response_type res;
+		res.result(http::status::unknown);
+		res.reason(ec.message());
+		return res;
+	}
+}
+
+void Request_Engine::enqueue(std::vector<Connection::request_type> requests, Connection::pipeline_handler handler)
+{
+	net::post(ioc_, [this, requests = std::move(requests), handler = std::move(handler)]() mutable {
+		queue_.push_back({ std::move(requests), std::move(handler), {}, false });
+		dispatch();
+	});
+}
+
+void Request_Engine::async_request(http::verb type, std::string target, response_handler handler)
+{
+	async_request(type, std::move(target), {}, std::move(handler));
+}
+
+void Request_Engine::async_request(http::verb type, std::string target, const header_list& headers, response_handler handler)
+{
+	// The total covers queueing, rate limiting and retries
+	auto name = Metrics::endpoint(type, target) + ".total";
+	attempt_request(make_message(type, target, headers), 1,
+		[this, name = std::move(name), start = std::chrono::steady_clock::now(), handler = std::move(handler)](beast::error_code ec, response_type res) {
+			metrics_.record(name, start);
+			handler(ec, std::move(res));
+		});
+}
+
+void Request_Engine::attempt_request(Connection::request_type message, std::size_t attempt, response_handler handler)
+{
+	enqueue({ message }, [this, message, attempt, handler = std::move(handler)](beast::error_code ec, std::vector<response_type> responses) {
+		auto res = responses.empty() ? response_type{} : std::move(responses.front());
+
+		if (auto delay = options_.retry.next_delay(message.method(), ec, res.base(), attempt, random_)) {
+			return after(*delay, [this, message, attempt, handler]() {
+				attempt_request(message, attempt + 1, handler);
+			});
+		}
+		handler(ec, std::move(res));
+	});
+}
+
+void Request_Engine::async_prefetch(std::string target, const header_list& headers, response_handler handler)
+{
+	net::post(ioc_, [this, message = make_message(http::verb::get, target, headers), handler = std::move(handler)]() mutable {
+		background_.push_back({ { std::move(message) }, [handler = std::move(handler)](beast::error_code ec, std::vector<response_type> responses) {
+			handler(ec, responses.empty() ? response_type{} : std::move(responses.front()));
+		}, {}, false });
+		dispatch();
+	});
+}
+
+void Request_Engine::cancel_background()
+{
+	net::post(ioc_, [this]() {
+		background_.clear();
+	});
+}
+
+void Request_Engine::async_get_all(std::vector<std::string> targets, results_handler handler)
+{
+	std::vector<std::string> names;
+	names.reserve(targets.size());
+	for (const auto& target : targets) {
+		names.push_back(Metrics::endpoint(http::verb::get, target) + ".total");
+	}
+
+	attempt_get_all(std::move(targets), 1,
+		[this, names = std::move(names), start = std::chrono::steady_clock::now(), handler = std::move(handler)](std::vector<Result> results) {
+			for (const auto& name : names) {
+				metrics_.record(name, start);
+			}
+			handler(std::move(results));
+		});
+}
+
+void Request_Engine::attempt_get_all(std::vector<std::string> targets, std::size_t attempt, results_handler handler)
+{
+	auto shared_targets = std::make_shared<std::vector<std::string>>(std::move(targets));
+
+	send_all(*shared_targets, [this, shared_targets, attempt, handler = std::move(handler)](std::vector<Result> results) {
+		// Retry only the targets that failed, after the longest of their delays
+		std::vector<std::size_t> failed;
+		std::chrono::milliseconds delay{ 0 };
+		for (std::size_t i = 0; i < results.size(); ++i) {
+			if (auto next = options_.retry.next_delay(http::verb::get, results[i].ec, results[i].response.base(), attempt, random_)) {
+				failed.push_back(i);
+				delay = std::max(delay, *next);
+			}
+		}
+
+		if (failed.empty()) {
+			return handler(std::move(results));
+		}
+
+		std::vector<std::string> again;
+		for (auto i : failed) {
+			again.push_back((*shared_targets)[i]);
+		}
+
+		auto merged = std::make_shared<std::vector<Result>>(std::move(results));
+		after(delay, [this, again = std::move(again), attempt, failed = std::move(failed), merged, handler]() {
+			attempt_get_all(again, attempt + 1, [failed, merged, handler](std::vector<Result> retried) {
+				for (std::size_t k = 0; k < failed.size(); ++k) {
+					(*merged)[failed[k]] = std::move(retried[k]);
+				}
+				handler(std::move(*merged));
+			});
+		});
+	});
+}
+
+void Request_Engine::send_all(const std::vector<std::string>& targets, results_handler handler)
+{
+	struct State {
+		std::vector<Result> results;
+		std::size_t remaining;
+		results_handler handler;
+	};
+
+	if (targets.empty()) {
+		net::post(ioc_, [handler = std::move(handler)]() { handler({}); });
+		return;
+	}
+
+	auto const depth = options_.pipelining ? std::max<std::size_t>(options_.pipeline_depth, 1) : 1;
+	auto const jobs = (targets.size() + depth - 1) / depth;
+	auto state = std::make_shared<State>(State{ std::vector<Result>(targets.size()), jobs, std::move(handler) });
+
+	for (std::size_t offset = 0; offset < targets.size(); offset += depth) {
+		auto const count = std::min(depth, targets.size() - offset);
+
+		std::vector<Connection::request_type> requests;
+		requests.reserve(count);
+		for (auto i = offset; i < offset + count; ++i) {
+			requests.push_back(make_message(http::verb::get, targets[i]));
+		}
+
+		enqueue(std::move(requests), [state, offset, count](beast::error_code ec, std::vector<response_type> responses) {
+			for (std::size_t i = 0; i < count; ++i) {
+				auto& result = state->results[offset + i];
+				if (i < responses.size()) {
+					result.response = std::move(responses[i]);
+				}
+				else {
+					result.ec = ec ? ec : net::error::operation_aborted;
+				}
+			}
+
+			if (--state->remaining == 0) {
+				state->handler(std::move(state->results));
+			}
+		});
+	}
+}
+
+void Request_Engine::after(std::chrono::milliseconds delay, std::function<void()> handler)
+{
+	auto timer = std::make_shared<net::steady_timer>(ioc_, delay);
+
+	// Forget timers that already fired
+	retry_timers_.erase(std::remove_if(retry_timers_.begin(), retry_timers_.end(), [](const std::weak_ptr<net::steady_timer>& timer) {
+		return timer.expired();
+	}), retry_timers_.end());
+	retry_timers_.push_back(timer);
+
+	// When cancelled on shutdown the handler still runs, the closed pool then fails the request
+	timer->async_wait([timer, handler = std::move(handler)](beast::error_code) {
+		handler();
+	});
+}
+
+void Request_Engine::dispatch()
+{
+	while (pool_ && in_flight_ < pool_->size() && !queue_.empty()) {
+		auto pending = std::make_shared<Pending>(std::move(queue_.front()));
+		queue_.pop_front();
+		++in_flight_;
+		send(std::move(pending));
+	}
+
+	dispatch_background();
+}
+
+void Request_Engine::dispatch_background()
+{
+	// One connection is always left for the user
+	while (pool_ && queue_.empty() && !background_.empty() && in_flight_ + 1 < pool_->size()) {
+		if (!limiter_.try_acquire(1)) {
+			// Look again once the buckets had time to refill
+			if (!background_waiting_) {
+				background_waiting_ = true;
+				background_timer_.expires_after(std::chrono::seconds(1));
+				background_timer_.async_wait([this](beast::error_code ec) {
+					background_waiting_ = false;
+					if (!ec) {
+						dispatch();
+					}
+				});
+			}
+			return;
+		}
+
+		auto pending = std::make_shared<Pending>(std::move(background_.front()));
+		background_.pop_front();
+		++in_flight_;
+		transmit(std::move(pending));
+	}
+}
+
+void Request_Engine::send(std::shared_ptr<Pending> pending)
+{
+	limiter_.async_acquire(pending->requests.size(), [this, pending]() {
+		transmit(pending);
+	});
+}
+
+void Request_Engine::transmit(std::shared_ptr<Pending> pending)
+{
+	pool_->async_checkout([this, pending](beast::error_code ec, std::shared_ptr<Connection> connection) {
+		if (ec) {
+			--in_flight_;
+			pending->handler(ec, std::move(pending->responses));
+			return dispatch();
+		}
+
+		auto const reused = connection->requests_completed() > 0;
+		requests_sent_ += pending->requests.size();
+		connection->async_pipeline(pending->requests, [this, connection, pending, reused](beast::error_code ec, std::vector<response_type> responses) {
+			pool_->checkin(connection);
+			for (const auto& res : responses) {
+				on_response(res);
+			}
+
+			auto const answered = responses.size();
+			std::move(responses.begin(), responses.end(), std::back_inserter(pending->responses));
+
+			// The server may have closed an idle keep-alive connection, or stopped answering
+			// in the middle of a pipeline. Replay the unanswered requests once on a new connection,
+			// unless a POST might already have reached the server.
+			if (ec && (reused || answered > 0) && !pending->replayed && is_stale_connection(ec)) {
+				pending->requests.erase(pending->requests.begin(), pending->requests.begin() + answered);
+				auto const safe = std::all_of(pending->requests.begin(), pending->requests.end(), [](const Connection::request_type& req) {
+					return Retry_Policy::is_idempotent(req.method());
+				});
+				if (safe || !connection->request_sent()) {
+					pending->replayed = true;
+					return send(pending);
+				}
+			}
+
+			--in_flight_;
+			pending->handler(ec, std::move(pending->responses));
+			dispatch();
+		});
+	});
+}
+
+void Request_Engine::on_response(const response_type& res)
+{
+	limiter_.update(res.base());
+	if (res.result() == http::status::too_many_requests) {
+		limiter_.throttle();
+	}
+}
+
+Request_Engine::response_type Request_Engine::request(http::verb type, std::string target, const header_list& headers)
+{
+	std::promise<response_type> promise;
+	auto future = promise.get_future();
+
+	async_request(type, std::move(target), headers, [&promise](beast::error_code ec, response_type res) {
+		promise.set_value(ec ? make_failure(ec) : std::move(res));
+	});
+
+	return future.get();
+}
+
+std::size_t Request_Engine::requests_sent() const
+{
+	return requests_sent_;
+}
+
+Metrics& Request_Engine::metrics()
+{
+	return metrics_;
+}
+
+void Request_Engine::release(response_type&& res)
+{
+	bodies_.release(std::move(res.body()));
+}
+
+void Request_Engine::stop()
+{
+	if (!thread_.joinable()) {
+		return;
+	}
+
+	// The io thread exits once the pool has finished closing its connections
+	net::post(ioc_, [this]() {
+		background_.clear();
+		background_timer_.cancel();
+		for (const auto& timer : retry_timers_) {
+			if (auto live = timer.lock()) {
+				live->cancel();
+			}
+		}
+		limiter_.close();
+		if (pool_) {
+			pool_->close();
+		}
+	});
+	work_.reset();
+	thread_.join();
+}
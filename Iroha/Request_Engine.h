@@ -0,0 +1,123 @@
+#pragma once
+#include "Connection_Pool.h"
+#include "Metrics.h"
+#include "Rate_Limiter.h"
+#include "Retry_Policy.h"
+#include <atomic>
+#include <deque>
+#include <thread>
+
+// Drives all Trello traffic on a background thread running the io_context.
+// Requests are queued with async_request() and complete through their handler
+// on the io thread. Up to one request per pooled connection is in flight at once,
+// paced by the rate limiter.
+class Request_Engine {
+public:
+	using response_type = Connection::response_type;
+	using response_handler = std::function<void(boost::beast::error_code, response_type)>;
+	// Extra request header fields, e.g. the validators of a conditional GET
+	using header_list = std::vector<std::pair<boost::beast::http::field, std::string>>;
+
+	// Outcome of one request of a bulk fetch
+	struct Result {
+		boost::beast::error_code ec;
+		response_type response;
+	};
+	using results_handler = std::function<void(std::vector<Result>)>;
+
+	// Tuning knobs, read from Config.yaml
+	struct Options {
+		std::size_t connections{ 4 };
+		std::chrono::seconds idle_timeout{ 50 };
+		bool pipelining{ false }; // Send bulk GETs back-to-back on one connection
+		std::size_t pipeline_depth{ 8 }; // Maximum number of requests in one pipeline
+		Retry_Policy retry{};
+	};
+
+private:
+	// One unit of work for a single connection: a request or a pipeline of GETs
+	struct Pending {
+		std::vector<Connection::request_type> requests;
+		Connection::pipeline_handler handler;
+		std::vector<response_type> responses; // Collected across replays
+		bool replayed{ false };
+	};
+
+	boost::asio::io_context& ioc_;
+	boost::asio::ssl::context& ctx_;
+	boost::asio::executor_work_guard<boost::asio::io_context::executor_type> work_;
+	std::string const host_;
+	unsigned short const port_;
+	unsigned short const version_;
+	Options const options_;
+	Body_Pool bodies_;
+	Metrics metrics_;
+	std::unique_ptr<Connection_Pool> pool_;
+	Rate_Limiter limiter_;
+	std::mt19937 random_{ std::random_device{}() }; // Retry jitter
+	std::vector<std::weak_ptr<boost::asio::steady_timer>> retry_timers_;
+	std::deque<Pending> queue_; // Only touched on the io thread
+	std::deque<Pending> background_; // Speculative requests, sent only when nothing else is waiting
+	boost::asio::steady_timer background_timer_;
+	bool background_waiting_{ false }; // The timer is armed to look at background_ again
+	std::size_t in_flight_{ 0 };
+	std::atomic<std::size_t> requests_sent_{ 0 }; // Including retries and replays
+	std::thread thread_;
+
+private:
+	Connection::request_type make_message(boost::beast::http::verb type, const std::string& target, const header_list& headers = {}) const;
+	void enqueue(std::vector<Connection::request_type> requests, Connection::pipeline_handler handler);
+	void dispatch();
+	void dispatch_background();
+	void send(std::shared_ptr<Pending> pending);
+	void transmit(std::shared_ptr<Pending> pending);
+	void on_response(const response_type& res);
+	void attempt_request(Connection::request_type message, std::size_t attempt, response_handler handler);
+	void attempt_get_all(std::vector<std::string> targets, std::size_t attempt, results_handler handler);
+	void send_all(const std::vector<std::string>& targets, results_handler handler);
+	void after(std::chrono::milliseconds delay, std::function<void()> handler);
+
+public:
+	Request_Engine(boost::asio::io_context& ioc, boost::asio::ssl::context& ctx, std::string host, unsigned short port, unsigned short version,
+		Options options);
+	~Request_Engine();
+
+	Request_Engine(const Request_Engine& other) = delete;
+	Request_Engine& operator=(const Request_Engine& other) = delete;
+
+	// Open the connection pool and start the io thread. Blocks until the handshakes are done.
+	bool start();
+
+	// Queue a request. The handler is invoked on the io thread.
+	// 429, 5xx and transport failures are retried according to the retry policy.
+	void async_request(boost::beast::http::verb type, std::string target, response_handler handler);
+	void async_request(boost::beast::http::verb type, std::string target, const header_list& headers, response_handler handler);
+
+	// Queue a speculative GET at low priority. It is sent only while no other request is queued,
+	// a connection stays free for the user and the rate limiter has plenty of headroom.
+	// It is not retried, and it is dropped if cancel_background() runs before it is sent.
+	void async_prefetch(std::string target, const header_list& headers, response_handler handler);
+
+	// Forget the speculative requests that were not sent yet
+	void cancel_background();
+
+	// Queue a request and wait for its response. Must not be called from the io thread.
+	// On a transport failure the response carries status "unknown" and the error message as reason.
+	response_type request(boost::beast::http::verb type, std::string target, const header_list& headers = {});
+
+	// Fetch several GET targets at once. With pipelining enabled they are written back-to-back
+	// on as few connections as possible, otherwise every target takes its own pooled connection.
+	// The handler receives one result per target, in the order of the targets.
+	void async_get_all(std::vector<std::string> targets, results_handler handler);
+
+	// Number of requests written to the network so far. Thread safe.
+	std::size_t requests_sent() const;
+
+	// Latency histograms of the network phases and of whole requests. Thread safe.
+	Metrics& metrics();
+
+	// Hand a decoded response back so the next response can reuse its body storage. Thread safe.
+	void release(response_type&& res);
+
+	void stop();
+};
@@ -0,0 +1,56 @@
+#include "Residency.h"
+
+Residency::Entry& Residency::entry(const Object_Id& id)
+{
+	auto it = entries_.find(id);
+	if (it != entries_.end()) {
+		// Move to the front without invalidating the other positions
+		order_.splice(order_.begin(), order_, it->second.position);
+		return it->second;
+	}
+
+	order_.push_front(id);
+	auto& added = entries_[id];
+	added.position = order_.begin();
+	return added;
+}
+
+void Residency::mark_fetched(const Object_Id& id)
+{
+	auto& fetched = entry(id);
+	fetched.fetched = clock::now();
+	fetched.was_fetched = true;
+}
+
+void Residency::touch(const Object_Id& id)
+{
+	entry(id);
+}
+
+void Residency::forget(const Object_Id& id)
+{
+	auto it = entries_.find(id);
+	if (it == entries_.end()) {
+		return;
+	}
+
+	order_.erase(it->second.position);
+	entries_.erase(it);
+}
+
+bool Residency::was_fetched(const Object_Id& id) const
+{
+	auto it = entries_.find(id);
+	return it != entries_.end() && it->second.was_fetched;
+}
+
+bool Residency::is_fresh(const Object_Id& id, clock::duration max_age) const
+{
+	auto it = entries_.find(id);
+	return it != entries_.end() && it->second.was_fetched && clock::now() - it->second.fetched < max_age;
+}
+
+const std::list<Object_Id>& Residency::by_recency() const
+{
+	return order_;
+}
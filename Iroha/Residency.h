@@ -0,0 +1,42 @@
+#pragma once
+#include "Object_Id.h"
+#include <chrono>
+#include <limits>
+#include <list>
+#include <robin-hood-hashing/robin_hood.h>
+
+// Bookkeeping for the mirrored collections held in memory: when each one was last downloaded
+// in this session, and which one was used least recently so it can be dropped first
+// when the mirror grows past its cap. Keyed by Trello ID, the workspace is the zero ID.
+class Residency {
+public:
+	using clock = std::chrono::steady_clock;
+
+private:
+	struct Entry {
+		clock::time_point fetched{};
+		bool was_fetched{ false };
+		std::list<Object_Id>::iterator position;
+	};
+
+	std::list<Object_Id> order_; // Most recently used at the front
+	robin_hood::unordered_map<Object_Id, Entry, Object_Id::Hash> entries_;
+
+private:
+	Entry& entry(const Object_Id& id);
+
+public:
+	// The collection was downloaded just now
+	void mark_fetched(const Object_Id& id);
+	// The collection was looked at
+	void touch(const Object_Id& id);
+	void forget(const Object_Id& id);
+
+	// Downloaded at any time in this session
+	bool was_fetched(const Object_Id& id) const;
+	// Downloaded less than max_age ago
+	bool is_fresh(const Object_Id& id, clock::duration max_age) const;
+
+	// IDs from most to least recently used
+	const std::list<Object_Id>& by_recency() const;
+};
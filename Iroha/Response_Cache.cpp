@@ -0,0 +1,59 @@
+#include "Response_Cache.h"
+
+namespace http = boost::beast::http;
+
+Request_Engine::header_list Response_Cache::validators(const std::string& target) const
+{
+	Request_Engine::header_list headers;
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	auto it = entries_.find(target);
+	if (it == entries_.end()) {
+		return headers;
+	}
+
+	// A server that sent an ETag only compares the ETag
+	if (!it->second.etag.empty()) {
+		headers.emplace_back(http::field::if_none_match, it->second.etag);
+	}
+	else {
+		headers.emplace_back(http::field::if_modified_since, it->second.last_modified);
+	}
+	return headers;
+}
+
+std::optional<Response_Cache::Mirror_Key> Response_Cache::find(const std::string& target) const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	auto it = entries_.find(target);
+	if (it == entries_.end()) {
+		return std::nullopt;
+	}
+	return it->second.key;
+}
+
+void Response_Cache::store(const std::string& target, const http::response_header<>& header, Mirror_Key key)
+{
+	Entry entry;
+	if (auto etag = header.find(http::field::etag); etag != header.end()) {
+		entry.etag = etag->value().to_string();
+	}
+	if (auto modified = header.find(http::field::last_modified); modified != header.end()) {
+		entry.last_modified = modified->value().to_string();
+	}
+
+	if (entry.etag.empty() && entry.last_modified.empty()) {
+		erase(target);
+		return;
+	}
+	entry.key = std::move(key);
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	entries_[target] = std::move(entry);
+}
+
+void Response_Cache::erase(const std::string& target)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	entries_.erase(target);
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include "Request_Engine.h"
+#include "Object_Id.h"
+#include <mutex>
+#include <optional>
+#include <robin-hood-hashing/robin_hood.h>
+
+// Remembers the validators of GET responses, keyed by request target, and where their records went
+// in the local mirror. A later GET of the same target sends If-None-Match / If-Modified-Since,
+// and a 304 takes the records from the mirror, so nothing is transferred, parsed or kept twice.
+// Shared between the main thread and the io thread.
+class Response_Cache {
+public:
+	// The mirrored record whose children a response held, or the record itself for one card.
+	// The ID is zero for the boards.
+	struct Mirror_Key {
+		enum class Level { boards, lists, cards, card };
+
+		Level level{ Level::boards };
+		Object_Id trello_id;
+	};
+
+private:
+	struct Entry {
+		std::string etag;
+		std::string last_modified;
+		Mirror_Key key;
+	};
+
+	mutable std::mutex mutex_;
+	robin_hood::unordered_map<std::string, Entry> entries_;
+
+public:
+	// Header fields that make a GET of the target conditional. Empty if nothing is cached.
+	Request_Engine::header_list validators(const std::string& target) const;
+
+	// Where the records of an earlier 200 response of the target were mirrored
+	std::optional<Mirror_Key> find(const std::string& target) const;
+
+	// Remember a 200 response whose records were mirrored under key.
+	// Responses without ETag or Last-Modified are not cached.
+	void store(const std::string& target, const boost::beast::http::response_header<>& header, Mirror_Key key);
+
+	void erase(const std::string& target);
+};
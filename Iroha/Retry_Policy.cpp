@@ -0,0 +1,68 @@
+#include "Retry_Policy.h"
+#include <algorithm>
+#include <string>
+
+namespace beast = boost::beast;
+namespace http = beast::http;
+namespace net = boost::asio;
+
+namespace {
+	bool is_transient(http::status status)
+	{
+		return status == http::status::internal_server_error
+			|| status == http::status::bad_gateway
+			|| status == http::status::service_unavailable
+			|| status == http::status::gateway_timeout;
+	}
+
+	// Retry-After in seconds, the HTTP date form is not used by Trello
+	std::chrono::milliseconds retry_after(const http::response_header<>& res)
+	{
+		auto it = res.find(http::field::retry_after);
+		if (it == res.end()) {
+			return std::chrono::milliseconds(0);
+		}
+
+		try {
+			return std::chrono::seconds(std::stol(std::string(it->value())));
+		}
+		catch (const std::exception&) {
+			return std::chrono::milliseconds(0);
+		}
+	}
+}
+
+bool Retry_Policy::is_idempotent(http::verb method)
+{
+	return method != http::verb::post;
+}
+
+std::optional<std::chrono::milliseconds> Retry_Policy::next_delay(http::verb method, const beast::error_code& ec,
+	const http::response_header<>& res, std::size_t attempt, std::mt19937& random) const
+{
+	if (attempt >= max_attempts) {
+		return std::nullopt;
+	}
+
+	bool retry = false;
+	if (ec) {
+		// Cancelled means the client is shutting down
+		retry = ec != net::error::operation_aborted && is_idempotent(method);
+	}
+	else if (res.result() == http::status::too_many_requests) {
+		retry = true;
+	}
+	else if (is_transient(res.result())) {
+		retry = is_idempotent(method);
+	}
+
+	if (!retry) {
+		return std::nullopt;
+	}
+
+	// Full jitter: uniform between zero and the exponential ceiling
+	auto const exponent = std::min<std::size_t>(attempt - 1, 16);
+	auto const ceiling = std::min<std::chrono::milliseconds>(cap, base * (1L << exponent));
+	std::uniform_int_distribution<std::chrono::milliseconds::rep> jitter(0, ceiling.count());
+	return std::max(std::chrono::milliseconds(jitter(random)), retry_after(res));
+}
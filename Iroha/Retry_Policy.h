@@ -0,0 +1,22 @@
+#pragma once
+#include <boost/beast/http.hpp>
+#include <chrono>
+#include <optional>
+#include <random>
+
+// Decides whether a failed request is worth another attempt and how long to wait before it.
+// 429 is retried for every method because Trello rejected the request without acting on it.
+// Transport errors and 5xx are only retried for idempotent methods, so a POST never creates twice.
+struct Retry_Policy {
+	std::size_t max_attempts{ 4 }; // Including the first one
+	std::chrono::milliseconds base{ 500 };
+	std::chrono::milliseconds cap{ 8000 };
+
+	// Whether repeating the request cannot apply it twice
+	static bool is_idempotent(boost::beast::http::verb method);
+
+	// Delay before the next attempt, or nothing if the result is final.
+	// The delay is exponential in the attempt number with full jitter, and never shorter than Retry-After.
+	std::optional<std::chrono::milliseconds> next_delay(boost::beast::http::verb method, const boost::beast::error_code& ec,
+		const boost::beast::http::response_header<>& res, std::size_t attempt, std::mt19937& random) const;
+};
@@ -0,0 +1,254 @@
+#include "Search_Index.h"
+#include <algorithm>
+#include <iterator>
+
+namespace {
+	char lower(char c)
+	{
+		return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+	}
+
+	std::string to_lower(std::string_view text)
+	{
+		std::string lowered(text);
+		std::transform(lowered.begin(), lowered.end(), lowered.begin(), lower);
+		return lowered;
+	}
+
+	std::uint32_t trigram(const char* text)
+	{
+		return static_cast<std::uint32_t>(static_cast<unsigned char>(text[0])) << 16
+			| static_cast<std::uint32_t>(static_cast<unsigned char>(text[1])) << 8
+			| static_cast<unsigned char>(text[2]);
+	}
+
+	// Distinct trigrams of the text, sorted
+	std::vector<std::uint32_t> trigrams(std::string_view text)
+	{
+		std::vector<std::uint32_t> grams;
+		for (std::size_t i = 0; i + 3 <= text.size(); ++i) {
+			grams.push_back(trigram(text.data() + i));
+		}
+		std::sort(grams.begin(), grams.end());
+		grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+		return grams;
+	}
+
+	std::vector<std::string_view> split_terms(std::string_view query)
+	{
+		std::vector<std::string_view> terms;
+		std::size_t start = 0;
+		while (start < query.size()) {
+			auto const end = query.find_first_of(" \t", start);
+			auto const length = (end == std::string_view::npos ? query.size() : end) - start;
+			if (length != 0) {
+				terms.push_back(query.substr(start, length));
+			}
+			if (end == std::string_view::npos) {
+				break;
+			}
+			start = end + 1;
+		}
+		return terms;
+	}
+}
+
+void Search_Index::add_postings(std::uint32_t document)
+{
+	// Documents are numbered in order, so appending keeps every posting list sorted
+	for (auto gram : trigrams(documents_[document].text)) {
+		postings_[gram].push_back(document);
+	}
+}
+
+void Search_Index::remove(std::uint32_t document)
+{
+	// The postings are cleaned up by the next compaction
+	documents_[document].alive = false;
+	documents_[document].text.clear();
+	documents_[document].text.shrink_to_fit();
+	++dead_;
+}
+
+void Search_Index::compact()
+{
+	// Posting lists carry the dead documents until they outnumber the live ones
+	if (dead_ <= 1024 || dead_ <= documents_.size() / 2) {
+		return;
+	}
+
+	std::vector<Document> alive;
+	alive.reserve(documents_.size() - dead_);
+	for (auto& document : documents_) {
+		if (document.alive) {
+			alive.push_back(std::move(document));
+		}
+	}
+
+	documents_ = std::move(alive);
+	dead_ = 0;
+	by_id_.clear();
+	postings_.clear();
+	for (std::uint32_t i = 0; i < documents_.size(); ++i) {
+		by_id_[documents_[i].trello_id] = i;
+		add_postings(i);
+	}
+}
+
+void Search_Index::clear()
+{
+	documents_.clear();
+	by_id_.clear();
+	postings_.clear();
+	dead_ = 0;
+}
+
+void Search_Index::begin_update()
+{
+	++generation_;
+}
+
+void Search_Index::update(const Object_Id& trello_id, std::string_view name, std::string_view desc)
+{
+	// Interned strings are equal only if they are the same string
+	auto same = [](std::string_view a, std::string_view b) {
+		return a.data() == b.data() && a.size() == b.size();
+	};
+
+	auto it = by_id_.find(trello_id);
+	if (it != by_id_.end()) {
+		auto& document = documents_[it->second];
+		document.generation = generation_;
+		if (same(document.name, name) && same(document.desc, desc)) {
+			// Only moved, or nothing changed at all
+			return;
+		}
+		remove(it->second);
+		compact();
+	}
+
+	auto text = to_lower(name);
+	text += '\n';
+	text += to_lower(desc);
+
+	auto const number = static_cast<std::uint32_t>(documents_.size());
+	documents_.push_back({ trello_id, name, desc, std::move(text), generation_, true });
+	by_id_[trello_id] = number;
+	add_postings(number);
+}
+
+void Search_Index::end_update()
+{
+	for (auto it = by_id_.begin(); it != by_id_.end();) {
+		if (documents_[it->second].generation != generation_) {
+			remove(it->second);
+			it = by_id_.erase(it);
+		}
+		else {
+			++it;
+		}
+	}
+
+	compact();
+}
+
+void Search_Index::erase(const Object_Id& trello_id)
+{
+	auto it = by_id_.find(trello_id);
+	if (it == by_id_.end()) {
+		return;
+	}
+
+	remove(it->second);
+	by_id_.erase(it);
+	compact();
+}
+
+std::vector<Search_Index::Match> Search_Index::search(std::string_view query, std::size_t limit, const Item_Index& positions) const
+{
+	auto const lowered = to_lower(query);
+	auto const terms = split_terms(lowered);
+	if (terms.empty()) {
+		return {};
+	}
+
+	// Intersect the posting lists of every trigram, smallest first
+	std::vector<const std::vector<std::uint32_t>*> lists;
+	for (auto term : terms) {
+		for (auto gram : trigrams(term)) {
+			auto it = postings_.find(gram);
+			if (it == postings_.end()) {
+				return {};
+			}
+			lists.push_back(&it->second);
+		}
+	}
+	std::sort(lists.begin(), lists.end(), [](const auto* a, const auto* b) {
+		return a->size() < b->size();
+	});
+
+	std::vector<std::uint32_t> candidates;
+	if (lists.empty()) {
+		// Only short terms, every document is a candidate
+		candidates.resize(documents_.size());
+		for (std::uint32_t i = 0; i < candidates.size(); ++i) {
+			candidates[i] = i;
+		}
+	}
+	else {
+		candidates = *lists.front();
+		for (std::size_t i = 1; i < lists.size() && !candidates.empty(); ++i) {
+			std::vector<std::uint32_t> narrowed;
+			std::set_intersection(candidates.begin(), candidates.end(), lists[i]->begin(), lists[i]->end(), std::back_inserter(narrowed));
+			candidates = std::move(narrowed);
+		}
+	}
+
+	// Trigrams only prove the pieces are there, check the whole terms
+	std::vector<Match> in_name;
+	std::vector<Match> in_desc;
+	for (auto number : candidates) {
+		const auto& document = documents_[number];
+		auto const path = document.alive ? positions.path_of(document.trello_id) : nullptr;
+		if (path == nullptr) {
+			continue;
+		}
+
+		auto const name_end = document.text.find('\n');
+		auto all = true;
+		auto name_only = true;
+		for (auto term : terms) {
+			auto const found = document.text.find(term);
+			if (found == std::string::npos) {
+				all = false;
+				break;
+			}
+			name_only = name_only && found < name_end;
+		}
+		if (all && name_only) {
+			in_name.push_back({ *path, document.name });
+		}
+		else if (all) {
+			in_desc.push_back({ *path, document.name });
+		}
+	}
+
+	// Documents are in insertion order, the first matches by path can be anywhere among them
+	auto first_by_path = [](std::vector<Match>& matches, std::size_t count) {
+		count = std::min(count, matches.size());
+		std::partial_sort(matches.begin(), matches.begin() + count, matches.end(), [](const Match& a, const Match& b) {
+			return a.path.key() < b.path.key();
+		});
+		matches.resize(count);
+	};
+	first_by_path(in_name, limit);
+	first_by_path(in_desc, limit - in_name.size());
+
+	in_name.insert(in_name.end(), in_desc.begin(), in_desc.end());
+	return in_name;
+}
+
+std::size_t Search_Index::size() const
+{
+	return by_id_.size();
+}
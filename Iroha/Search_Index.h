@@ -0,0 +1,60 @@
+#pragma once
+#include "Item_Index.h"
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <robin-hood-hashing/robin_hood.h>
+
+// In-memory full text index over the names and descriptions of the mirrored cards.
+// Text is lower cased and cut into byte trigrams, each trigram has a sorted posting list of documents.
+// A query term of three or more characters narrows the candidates to the intersection of its
+// trigram postings, every candidate is then checked for all terms as substrings.
+// Cards are updated one by one; only cards whose text changed are tokenized again.
+// Documents are keyed by Trello ID, their positions are looked up in the item index when searching.
+class Search_Index {
+public:
+	struct Match {
+		Item_Index::Path path;
+		std::string_view name;
+	};
+
+private:
+	struct Document {
+		Object_Id trello_id;
+		std::string_view name; // Interned by the mirror, like the description
+		std::string_view desc;
+		std::string text; // Lower cased name and description
+		std::uint64_t generation{ 0 };
+		bool alive{ true };
+	};
+
+	std::vector<Document> documents_;
+	robin_hood::unordered_map<Object_Id, std::uint32_t, Object_Id::Hash> by_id_; // Trello ID to its live document
+	robin_hood::unordered_flat_map<std::uint32_t, std::vector<std::uint32_t>> postings_;
+	std::uint64_t generation_{ 0 };
+	std::size_t dead_{ 0 };
+
+private:
+	void add_postings(std::uint32_t document);
+	void remove(std::uint32_t document);
+	// Drop the dead documents once they outnumber the live ones
+	void compact();
+
+public:
+	// Forget every card, e.g. when the strings they point to are gone
+	void clear();
+	// Start a pass over all cards. Cards not updated before end_update() are removed.
+	void begin_update();
+	// Add a card or replace its text. The name and description must be interned in one pool,
+	// a card is unchanged if both views are.
+	void update(const Object_Id& trello_id, std::string_view name, std::string_view desc);
+	void end_update();
+	void erase(const Object_Id& trello_id);
+
+	// Cards containing every whitespace separated term, case insensitive, name matches first.
+	// Cards missing from the item index are skipped. The names are valid until the next update.
+	std::vector<Match> search(std::string_view query, std::size_t limit, const Item_Index& positions) const;
+	std::size_t size() const;
+};
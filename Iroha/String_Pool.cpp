@@ -0,0 +1,56 @@
+#include "String_Pool.h"
+#include <cstring>
+
+std::string_view String_Pool::store(std::string_view text)
+{
+	bytes_ += text.size();
+
+	// Oversized strings get a block of their own
+	if (text.size() > block_size) {
+		large_.push_back(std::make_unique<char[]>(text.size()));
+		std::memcpy(large_.back().get(), text.data(), text.size());
+		return { large_.back().get(), text.size() };
+	}
+
+	if (blocks_.empty() || block_size - used_ < text.size()) {
+		blocks_.push_back(std::make_unique<char[]>(block_size));
+		used_ = 0;
+	}
+
+	auto position = blocks_.back().get() + used_;
+	std::memcpy(position, text.data(), text.size());
+	used_ += text.size();
+	return { position, text.size() };
+}
+
+std::string_view String_Pool::intern(std::string_view text)
+{
+	// Empty names and descriptions are common, they take no storage.
+	// A fresh pool has no block yet to point into.
+	if (text.empty()) {
+		return {};
+	}
+
+	auto it = strings_.find(text);
+	if (it != strings_.end()) {
+		return *it;
+	}
+
+	auto stored = store(text);
+	strings_.insert(stored);
+	return stored;
+}
+
+void String_Pool::clear()
+{
+	strings_.clear();
+	blocks_.clear();
+	large_.clear();
+	used_ = block_size;
+	bytes_ = 0;
+}
+
+std::size_t String_Pool::bytes() const
+{
+	return bytes_;
+}
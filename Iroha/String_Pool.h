@@ -0,0 +1,29 @@
+#pragma once
+#include <limits>
+#include <memory>
+#include <string_view>
+#include <vector>
+#include <robin-hood-hashing/robin_hood.h>
+
+// Interned strings stored back-to-back in large blocks.
+// Equal strings are stored once, the returned views stay valid until clear().
+class String_Pool {
+public:
+	static constexpr std::size_t block_size = 64 * 1024;
+
+private:
+	std::vector<std::unique_ptr<char[]>> blocks_;
+	std::vector<std::unique_ptr<char[]>> large_; // Strings longer than a block
+	std::size_t used_{ block_size }; // Bytes taken in the last block
+	std::size_t bytes_{ 0 }; // Taken by all strings
+	robin_hood::unordered_flat_set<std::string_view> strings_;
+
+private:
+	std::string_view store(std::string_view text);
+
+public:
+	std::string_view intern(std::string_view text);
+	void clear();
+	// Total length of the stored strings
+	std::size_t bytes() const;
+};
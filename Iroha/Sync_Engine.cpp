@@ -0,0 +1,199 @@
+#include "Sync_Engine.h"
+#include <algorithm>
+#include "fmt/format.h"
+
+namespace {
+	// Only actions that change a name, a description, the order or the membership of a mirrored record
+	constexpr auto action_filter = "createCard,copyCard,convertToCardFromCheckItem,updateCard,deleteCard,"
+		"moveCardToBoard,moveCardFromBoard,createList,updateList,moveListToBoard,moveListFromBoard,updateBoard";
+
+	std::string string_field(const nlohmann::json& object, const char* key)
+	{
+		auto it = object.find(key);
+		return it != object.end() && it->is_string() ? it->get<std::string>() : std::string{};
+	}
+
+	// The zero ID if the field is missing or not a Trello ID
+	Object_Id id_field(const nlohmann::json& object, const char* key)
+	{
+		return Object_Id::parse(string_field(object, key)).value_or(Object_Id{});
+	}
+
+	// Copy the fields an update action carries into the mirrored record
+	void update_record(Local_Mirror& mirror, Local_Mirror::Record& record, std::uint32_t depth, const nlohmann::json& source)
+	{
+		if (auto name = source.find("name"); name != source.end() && name->is_string()) {
+			mirror.set_name(record, depth, name->get_ref<const std::string&>());
+		}
+		if (auto desc = source.find("desc"); desc != source.end() && desc->is_string()) {
+			mirror.set_desc(record, depth, desc->get_ref<const std::string&>());
+		}
+		if (auto pos = source.find("pos"); pos != source.end() && pos->is_number()) {
+			record.pos = pos->get<double>();
+		}
+	}
+
+	// New records without a position go to the bottom, like Trello does
+	Local_Mirror::Record make_record(Local_Mirror& mirror, const nlohmann::json& source, const std::vector<Local_Mirror::Record>& siblings,
+		std::uint32_t depth)
+	{
+		Local_Mirror::Record record;
+		record.trello_id = id_field(source, "id");
+		record.pos = siblings.empty() ? 0 : siblings.back().pos + 1;
+		update_record(mirror, record, depth, source);
+		return record;
+	}
+}
+
+Sync_Engine::Sync_Engine(Local_Mirror& mirror) :
+	mirror_{ mirror }
+{
+}
+
+std::string Sync_Engine::target(const Object_Id& board_id, const std::string& since, const std::string& secrect)
+{
+	if (since.empty()) {
+		return fmt::format("/1/boards/{}/actions?limit=1&fields=id&{}", board_id.to_string(), secrect);
+	}
+	return fmt::format("/1/boards/{}/actions?since={}&limit={}&filter={}&fields=type,data&{}", board_id.to_string(), since, page_limit,
+		action_filter, secrect);
+}
+
+bool Sync_Engine::apply(const Object_Id& board_id, const nlohmann::json& actions)
+{
+	auto board = mirror_.find_board(board_id);
+	if (board == nullptr || !actions.is_array() || actions.size() >= page_limit) {
+		return false;
+	}
+
+	if (actions.empty()) {
+		return true;
+	}
+
+	auto const since = board->last_action;
+	auto const newest = string_field(actions.front(), "id");
+
+	// Without a starting point the page only tells where the next sync begins
+	if (!since.empty()) {
+		// The feed is newest first
+		for (auto it = actions.rbegin(); it != actions.rend(); ++it) {
+			auto const type = string_field(*it, "type");
+			auto data = it->find("data");
+			if (data == it->end() || !data->is_object()) {
+				continue;
+			}
+
+			if (type.find("Card") != std::string::npos) {
+				apply_card_action(type, *data);
+			}
+			else if (type.find("List") != std::string::npos) {
+				apply_list_action(board_id, type, *data);
+			}
+			else {
+				apply_board_action(board_id, type, *data);
+			}
+		}
+	}
+
+	// Applying may have removed the board
+	if (auto current = mirror_.find_board(board_id)) {
+		current->last_action = newest;
+	}
+	return true;
+}
+
+void Sync_Engine::apply_card_action(const std::string& type, const nlohmann::json& data)
+{
+	auto card = data.find("card");
+	if (card == data.end() || !card->is_object()) {
+		return;
+	}
+	auto const card_id = id_field(*card, "id");
+
+	if (type == "deleteCard" || type == "moveCardFromBoard") {
+		mirror_.remove_card(card_id);
+		return;
+	}
+
+	if (type == "updateCard") {
+		auto list_after = data.find("listAfter");
+		auto const closed = card->value("closed", false);
+		if (closed || list_after != data.end()) {
+			// Archived or moved to another list
+			auto existing = mirror_.find_card(card_id);
+			auto moved = existing != nullptr ? *existing : Local_Mirror::Record{};
+			mirror_.remove_card(card_id);
+			if (closed || list_after == data.end()) {
+				return;
+			}
+
+			auto target = mirror_.find_list(id_field(*list_after, "id"));
+			if (target == nullptr || !target->loaded) {
+				return;
+			}
+			if (existing == nullptr) {
+				moved = make_record(mirror_, *card, target->children, 3);
+			}
+			update_record(mirror_, moved, 3, *card);
+			mirror_.insert_card(target->trello_id, std::move(moved));
+			return;
+		}
+
+		if (auto existing = mirror_.find_card(card_id)) {
+			update_record(mirror_, *existing, 3, *card);
+			mirror_.reposition(card_id);
+		}
+		return;
+	}
+
+	// Every other card action adds a card to a list
+	auto list = data.find("list");
+	if (list == data.end() || mirror_.find_card(card_id) != nullptr) {
+		return;
+	}
+
+	auto target = mirror_.find_list(id_field(*list, "id"));
+	if (target != nullptr && target->loaded) {
+		mirror_.insert_card(target->trello_id, make_record(mirror_, *card, target->children, 3));
+	}
+}
+
+void Sync_Engine::apply_list_action(const Object_Id& board_id, const std::string& type, const nlohmann::json& data)
+{
+	auto list = data.find("list");
+	if (list == data.end() || !list->is_object()) {
+		return;
+	}
+	auto const list_id = id_field(*list, "id");
+	auto board = mirror_.find_board(board_id);
+
+	if (type == "moveListFromBoard" || (type == "updateList" && list->value("closed", false))) {
+		mirror_.remove_list(list_id);
+		return;
+	}
+
+	if (type == "updateList") {
+		if (auto existing = mirror_.find_list(list_id)) {
+			update_record(mirror_, *existing, 2, *list);
+			mirror_.reposition(list_id);
+		}
+		return;
+	}
+
+	// createList and moveListToBoard
+	if (board != nullptr && board->loaded && mirror_.find_list(list_id) == nullptr) {
+		mirror_.insert_list(board_id, make_record(mirror_, *list, board->children, 2));
+	}
+}
+
+void Sync_Engine::apply_board_action(const Object_Id& board_id, const std::string& type, const nlohmann::json& data)
+{
+	auto board = data.find("board");
+	if (type != "updateBoard" || board == data.end() || !board->is_object()) {
+		return;
+	}
+
+	if (auto existing = mirror_.find_board(board_id)) {
+		update_record(mirror_, *existing, 1, *board);
+	}
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include "Local_Mirror.h"
+#include <nlohmann/json.hpp>
+
+// Brings a mirrored board up to date from its actions feed,
+// /1/boards/{id}/actions?since=<last action id>, instead of downloading every list and card again.
+class Sync_Engine {
+public:
+	// Largest page Trello returns. A full page means older changes may be missing.
+	static constexpr std::size_t page_limit = 1000;
+
+private:
+	Local_Mirror& mirror_;
+
+private:
+	void apply_card_action(const std::string& type, const nlohmann::json& data);
+	void apply_list_action(const Object_Id& board_id, const std::string& type, const nlohmann::json& data);
+	void apply_board_action(const Object_Id& board_id, const std::string& type, const nlohmann::json& data);
+
+public:
+	explicit Sync_Engine(Local_Mirror& mirror);
+
+	// Actions since the given one, newest first. With an empty since only the newest action is requested,
+	// which gives a starting point for the next sync.
+	static std::string target(const Object_Id& board_id, const std::string& since, const std::string& secrect);
+
+	// Apply one page of the feed to the mirror and remember the newest action.
+	// Returns false if the page cannot be applied incrementally and the board has to be downloaded again.
+	bool apply(const Object_Id& board_id, const nlohmann::json& actions);
+};
@@ -35,34 +35,113 @@ SOFTWARE.
 #include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <tabulate/format.hpp>
 #include <tabulate/utf8.hpp>
 #include <vector>
 
 namespace tabulate {
 
+// The text of a cell word-wrapped to its column, as spans of trimmed lines.
+// Computed once per render and shared by the height computation and the printer.
+struct CellLayout {
+  struct Line {
+    size_t offset;
+    size_t length;
+    size_t width; // Display width
+  };
+
+  std::string text; // Wrapped text the lines point into, empty for a nested table
+  std::vector<Line> lines;
+  size_t height{0}; // Lines plus top and bottom padding
+
+  std::string_view line(size_t index) const {
+    return std::string_view(text).substr(lines[index].offset, lines[index].length);
+  }
+};
+
+// Row heights, column widths and output lines of a table, computed once per render.
+// A nested table is printed from its layout one line at a time, straight into the
+// output of the cell that holds it.
+struct TableLayout {
+  enum class LineKind { top_border, content, blank, bottom_border };
+
+  struct Line {
+    LineKind kind;
+    size_t row;
+    size_t row_line{0};              // Line within the row, for content lines
+    bool top_border_prefix{false};   // Top border of the cells that have one, when others do not
+    bool bottom_border_suffix{false}; // Likewise for the bottom border of the last row
+    size_t width{0};                 // Display width
+  };
+
+  std::vector<size_t> row_heights;
+  std::vector<size_t> column_widths;
+  std::vector<Line> lines;
+  size_t width{0}; // Display width of the widest line
+};
+
 class Cell {
 public:
   explicit Cell(std::shared_ptr<class Row> parent) : parent_(parent) {}
 
-  void set_text(const std::string &text) { data_ = text; }
+  void set_text(const std::string &text) {
+    data_ = text;
+    // A table nesting this cell caches its layout, so the text invalidates like a format
+    Format::touch();
+  }
+
+  // Show a table in this cell. It stays live and is printed line by line into this
+  // cell's output, instead of being rendered to text when it is added.
+  void set_table(std::shared_ptr<class TableInternal> table) {
+    nested_ = std::move(table);
+    Format::touch();
+  }
+
+  bool has_table() const { return nested_ != nullptr; }
 
-  const std::string &get_text() { return data_; }
+  // The text, or the nested table rendered to text for the exporters.
+  // The rendering is cached until Format::generation() changes.
+  const std::string &get_text();
 
   size_t size() {
     return get_sequence_length(data_, locale(), is_multi_byte_character_support_enabled());
   }
 
-  std::string locale() { return format().locale_.value(); }
+  const std::string &locale() { return resolved().locale_.value(); }
 
+  // The formatting set on this cell only
   Format &format();
 
+  // Cell formatting merged with the row and table formatting.
+  // Cached until Format::generation() changes.
+  const Format &resolved();
+
   bool is_multi_byte_character_support_enabled();
 
+  // The text wrapped to the given column width, cached until the width,
+  // the text or Format::generation() changes
+  const CellLayout &layout(size_t column_width);
+
+  // The layout of the nested table, cached until Format::generation() changes
+  const TableLayout &table_layout();
+
 private:
+  friend class Printer;
+
   std::string data_;
   std::weak_ptr<class Row> parent_;
   std::optional<Format> format_;
+  Format resolved_;
+  size_t resolved_generation_{0};
+  CellLayout layout_;
+  size_t layout_width_{0};
+  size_t layout_generation_{0};
+  std::shared_ptr<class TableInternal> nested_;
+  std::shared_ptr<TableLayout> nested_layout_;
+  size_t nested_layout_generation_{0};
+  std::string nested_text_;
+  size_t nested_text_generation_{0};
 };
 
 } // namespace tabulate
\ No newline at end of file
@@ -93,8 +93,7 @@ private:
   size_t get_configured_width() {
     size_t result{0};
     for (size_t i = 0; i < size(); ++i) {
-      auto cell = cells_[i];
-      auto format = cell.get().format();
+      const auto &format = cells_[i].get().resolved();
       if (format.width_.has_value())
         result = std::max(result, format.width_.value());
     }
@@ -122,12 +121,20 @@ private:
   size_t get_cell_width(size_t cell_index) {
     size_t result{0};
     Cell &cell = cells_[cell_index].get();
-    auto format = cell.format();
+    const auto &format = cell.resolved();
     if (format.padding_left_.has_value())
       result += format.padding_left_.value();
 
+    if (cell.has_table()) {
+      // A nested table is as wide as its widest line
+      result += cell.table_layout().width;
+      if (format.padding_right_.has_value())
+        result += format.padding_right_.value();
+      return result;
+    }
+
     // Check if input text has newlines
-    auto text = cell.get_text();
+    const auto &text = cell.get_text();
     auto split_lines = Format::split_lines(text, "\n", cell.locale(),
                                            cell.is_multi_byte_character_support_enabled());
 
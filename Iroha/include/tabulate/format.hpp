@@ -32,6 +32,7 @@ SOFTWARE.
 */
 #pragma once
 #include <algorithm>
+#include <atomic>
 #include <cctype>
 #include <cstddef>
 #include <optional>
@@ -47,17 +48,24 @@ namespace tabulate {
 
 class Format {
 public:
+  // Changes whenever a setter runs anywhere. Cells and rows keep their merged
+  // format until the generation moves on, so a render merges each one only once.
+  static size_t generation() { return generation_counter().load(std::memory_order_relaxed); }
+
   Format &width(size_t value) {
+    touch();
     width_ = value;
     return *this;
   }
 
   Format &height(size_t value) {
+    touch();
     height_ = value;
     return *this;
   }
 
   Format &padding(size_t value) {
+    touch();
     padding_left_ = value;
     padding_right_ = value;
     padding_top_ = value;
@@ -66,26 +74,31 @@ public:
   }
 
   Format &padding_left(size_t value) {
+    touch();
     padding_left_ = value;
     return *this;
   }
 
   Format &padding_right(size_t value) {
+    touch();
     padding_right_ = value;
     return *this;
   }
 
   Format &padding_top(size_t value) {
+    touch();
     padding_top_ = value;
     return *this;
   }
 
   Format &padding_bottom(size_t value) {
+    touch();
     padding_bottom_ = value;
     return *this;
   }
 
   Format &border(const std::string &value) {
+    touch();
     border_left_ = value;
     border_right_ = value;
     border_top_ = value;
@@ -94,6 +107,7 @@ public:
   }
 
   Format &border_color(Color value) {
+    touch();
     border_left_color_ = value;
     border_right_color_ = value;
     border_top_color_ = value;
@@ -102,6 +116,7 @@ public:
   }
 
   Format &border_background_color(Color value) {
+    touch();
     border_left_background_color_ = value;
     border_right_background_color_ = value;
     border_top_background_color_ = value;
@@ -110,66 +125,79 @@ public:
   }
 
   Format &border_left(const std::string &value) {
+    touch();
     border_left_ = value;
     return *this;
   }
 
   Format &border_left_color(Color value) {
+    touch();
     border_left_color_ = value;
     return *this;
   }
 
   Format &border_left_background_color(Color value) {
+    touch();
     border_left_background_color_ = value;
     return *this;
   }
 
   Format &border_right(const std::string &value) {
+    touch();
     border_right_ = value;
     return *this;
   }
 
   Format &border_right_color(Color value) {
+    touch();
     border_right_color_ = value;
     return *this;
   }
 
   Format &border_right_background_color(Color value) {
+    touch();
     border_right_background_color_ = value;
     return *this;
   }
 
   Format &border_top(const std::string &value) {
+    touch();
     border_top_ = value;
     return *this;
   }
 
   Format &border_top_color(Color value) {
+    touch();
     border_top_color_ = value;
     return *this;
   }
 
   Format &border_top_background_color(Color value) {
+    touch();
     border_top_background_color_ = value;
     return *this;
   }
 
   Format &border_bottom(const std::string &value) {
+    touch();
     border_bottom_ = value;
     return *this;
   }
 
   Format &border_bottom_color(Color value) {
+    touch();
     border_bottom_color_ = value;
     return *this;
   }
 
   Format &border_bottom_background_color(Color value) {
+    touch();
     border_bottom_background_color_ = value;
     return *this;
   }
 
   Format &show_border() {
+    touch();
     show_border_top_ = true;
     show_border_bottom_ = true;
     show_border_left_ = true;
@@ -178,6 +206,7 @@ public:
   }
 
   Format &hide_border() {
+    touch();
     show_border_top_ = false;
     show_border_bottom_ = false;
     show_border_left_ = false;
@@ -186,46 +215,55 @@ public:
   }
 
   Format &show_border_top() {
+    touch();
     show_border_top_ = true;
     return *this;
   }
 
   Format &hide_border_top() {
+    touch();
     show_border_top_ = false;
     return *this;
   }
 
   Format &show_border_bottom() {
+    touch();
     show_border_bottom_ = true;
     return *this;
   }
 
   Format &hide_border_bottom() {
+    touch();
     show_border_bottom_ = false;
     return *this;
   }
 
   Format &show_border_left() {
+    touch();
     show_border_left_ = true;
     return *this;
   }
 
   Format &hide_border_left() {
+    touch();
     show_border_left_ = false;
     return *this;
   }
 
   Format &show_border_right() {
+    touch();
     show_border_right_ = true;
     return *this;
   }
 
   Format &hide_border_right() {
+    touch();
     show_border_right_ = false;
     return *this;
   }
 
   Format &corner(const std::string &value) {
+    touch();
     corner_top_left_ = value;
     corner_top_right_ = value;
     corner_bottom_left_ = value;
@@ -234,6 +272,7 @@ public:
   }
 
   Format &corner_color(Color value) {
+    touch();
     corner_top_left_color_ = value;
     corner_top_right_color_ = value;
     corner_bottom_left_color_ = value;
@@ -242,6 +281,7 @@ public:
   }
 
   Format &corner_background_color(Color value) {
+    touch();
     corner_top_left_background_color_ = value;
     corner_top_right_background_color_ = value;
     corner_bottom_left_background_color_ = value;
@@ -250,86 +290,103 @@ public:
   }
 
   Format &corner_top_left(const std::string &value) {
+    touch();
     corner_top_left_ = value;
     return *this;
   }
 
   Format &corner_top_left_color(Color value) {
+    touch();
     corner_top_left_color_ = value;
     return *this;
   }
 
   Format &corner_top_left_background_color(Color value) {
+    touch();
     corner_top_left_background_color_ = value;
     return *this;
   }
 
   Format &corner_top_right(const std::string &value) {
+    touch();
     corner_top_right_ = value;
     return *this;
   }
 
   Format &corner_top_right_color(Color value) {
+    touch();
     corner_top_right_color_ = value;
     return *this;
   }
 
   Format &corner_top_right_background_color(Color value) {
+    touch();
     corner_top_right_background_color_ = value;
     return *this;
   }
 
   Format &corner_bottom_left(const std::string &value) {
+    touch();
     corner_bottom_left_ = value;
     return *this;
   }
 
   Format &corner_bottom_left_color(Color value) {
+    touch();
     corner_bottom_left_color_ = value;
     return *this;
   }
 
   Format &corner_bottom_left_background_color(Color value) {
+    touch();
     corner_bottom_left_background_color_ = value;
     return *this;
   }
 
   Format &corner_bottom_right(const std::string &value) {
+    touch();
     corner_bottom_right_ = value;
     return *this;
   }
 
   Format &corner_bottom_right_color(Color value) {
+    touch();
     corner_bottom_right_color_ = value;
     return *this;
   }
 
   Format &corner_bottom_right_background_color(Color value) {
+    touch();
     corner_bottom_right_background_color_ = value;
     return *this;
   }
 
   Format &column_separator(const std::string &value) {
+    touch();
     column_separator_ = value;
     return *this;
   }
 
   Format &column_separator_color(Color value) {
+    touch();
     column_separator_color_ = value;
     return *this;
   }
 
   Format &column_separator_background_color(Color value) {
+    touch();
     column_separator_background_color_ = value;
     return *this;
   }
 
   Format &font_align(FontAlign value) {
+    touch();
     font_align_ = value;
     return *this;
   }
 
   Format &font_style(const std::vector<FontStyle> &style) {
+    touch();
     if (font_style_.has_value()) {
       for (auto &s : style)
         font_style_.value().push_back(s);
@@ -340,16 +397,19 @@ public:
   }
 
   Format &font_color(Color value) {
+    touch();
     font_color_ = value;
     return *this;
   }
 
   Format &font_background_color(Color value) {
+    touch();
     font_background_color_ = value;
     return *this;
   }
 
   Format &color(Color value) {
+    touch();
     font_color(value);
     border_color(value);
     corner_color(value);
@@ -357,6 +417,7 @@ public:
   }
 
   Format &background_color(Color value) {
+    touch();
     font_background_color(value);
     border_background_color(value);
     corner_background_color(value);
@@ -364,11 +425,13 @@ public:
   }
 
   Format &multi_byte_characters(bool value) {
+    touch();
     multi_byte_characters_ = value;
     return *this;
   }
 
   Format &locale(const std::string &value) {
+    touch();
     locale_ = value;
     return *this;
   }
@@ -418,14 +481,13 @@ public:
                                               const std::string &locale,
                                               bool is_multi_byte_character_support_enabled) {
     std::vector<std::string> result{};
-    std::string input = text;
+    size_t start = 0;
     size_t pos = 0;
-    std::string token;
-    while ((pos = input.find(delimiter)) != std::string::npos) {
-      token = input.substr(0, pos);
-      result.push_back(token);
-      input.erase(0, pos + delimiter.length());
+    while ((pos = text.find(delimiter, start)) != std::string::npos) {
+      result.push_back(text.substr(start, pos - start));
+      start = pos + delimiter.length();
     }
+    auto input = text.substr(start);
     if (get_sequence_length(input, locale, is_multi_byte_character_support_enabled))
       result.push_back(input);
     return result;
@@ -437,7 +499,7 @@ public:
   // second = row-level formatting
   // Result has attributes of both with cell-level
   // formatting taking precedence
-  static Format merge(Format first, Format second) {
+  static Format merge(const Format &first, const Format &second) {
     Format result;
 
     // Width and height
@@ -459,16 +521,16 @@ public:
 
     if (first.font_style_.has_value()) {
       // Merge font styles using std::set_union
-      std::vector<FontStyle> merged_font_style(first.font_style_.value().size() +
-                                               second.font_style_.value().size());
+      auto first_style = first.font_style_.value();
+      auto second_style = second.font_style_.value();
+      std::vector<FontStyle> merged_font_style(first_style.size() + second_style.size());
 #if defined(_WIN32) || defined(_WIN64)
       // Fixes error in Windows - Sequence not ordered
-      std::sort(first.font_style_.value().begin(), first.font_style_.value().end());
-      std::sort(second.font_style_.value().begin(), second.font_style_.value().end());
+      std::sort(first_style.begin(), first_style.end());
+      std::sort(second_style.begin(), second_style.end());
 #endif
-      std::set_union(first.font_style_.value().begin(), first.font_style_.value().end(),
-                     second.font_style_.value().begin(), second.font_style_.value().end(),
-                     merged_font_style.begin());
+      std::set_union(first_style.begin(), first_style.end(), second_style.begin(),
+                     second_style.end(), merged_font_style.begin());
       result.font_style_ = merged_font_style;
     } else
       result.font_style_ = second.font_style_;
@@ -686,7 +748,15 @@ private:
   friend class LatexExporter;
   friend class AsciiDocExporter;
 
+  static std::atomic<size_t> &generation_counter() {
+    static std::atomic<size_t> counter{1};
+    return counter;
+  }
+
+  static void touch() { generation_counter().fetch_add(1, std::memory_order_relaxed); }
+
   void set_defaults() {
+    touch();
     // NOTE: width and height are not set here
     font_align_ = FontAlign::left;
     font_style_ = std::vector<FontStyle>{};
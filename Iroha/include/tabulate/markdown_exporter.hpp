@@ -55,7 +55,7 @@ private:
       // Create alignment header cells
       std::vector<std::string> alignment_cells{};
       for (auto &cell : table[0]) {
-        auto format = cell.format();
+        const auto &format = cell.resolved();
         if (format.font_align_.value() == FontAlign::left) {
           alignment_cells.push_back(":----");
         } else if (format.font_align_.value() == FontAlign::center) {
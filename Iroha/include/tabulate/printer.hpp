@@ -33,6 +33,7 @@ SOFTWARE.
 #pragma once
 #include <tabulate/color.hpp>
 #include <tabulate/font_style.hpp>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -43,8 +44,14 @@ public:
   static std::pair<std::vector<size_t>, std::vector<size_t>>
   compute_cell_dimensions(TableInternal &table);
 
+  static TableLayout compute_layout(TableInternal &table);
+
   static void print_table(std::ostream &stream, TableInternal &table);
 
+  // Print one line of the layout without a line break
+  static void print_table_line(std::ostream &stream, TableInternal &table,
+                               const TableLayout &layout, size_t line_index);
+
   static void print_row_in_cell(std::ostream &stream, TableInternal &table,
                                 const std::pair<size_t, size_t> &index,
                                 const std::pair<size_t, size_t> &dimension, size_t num_columns,
@@ -70,14 +77,51 @@ public:
   static void reset_element_style(std::ostream &stream) { stream << termcolor::reset; }
 
 private:
-  static void print_content_left_aligned(std::ostream &stream, const std::string &cell_content,
+  // A line of a nested table, printed in place of cell text
+  struct NestedLine {
+    TableInternal &table;
+    const TableLayout &layout;
+    size_t index;
+  };
+
+  static void write_content(std::ostream &stream, std::string_view cell_content) {
+    stream << cell_content;
+  }
+
+  static void write_content(std::ostream &stream, const NestedLine &cell_content);
+
+  static size_t border_width(TableInternal &table, size_t row, const std::vector<size_t> &widths,
+                             bool top);
+
+  template <typename Content>
+  static void print_content(std::ostream &stream, const Content &cell_content,
+                            const Format &format, size_t text_with_padding_size,
+                            size_t column_width) {
+    switch (format.font_align_.value()) {
+    case FontAlign::left:
+      print_content_left_aligned(stream, cell_content, format, text_with_padding_size,
+                                 column_width);
+      break;
+    case FontAlign::center:
+      print_content_center_aligned(stream, cell_content, format, text_with_padding_size,
+                                   column_width);
+      break;
+    case FontAlign::right:
+      print_content_right_aligned(stream, cell_content, format, text_with_padding_size,
+                                  column_width);
+      break;
+    }
+  }
+
+  template <typename Content>
+  static void print_content_left_aligned(std::ostream &stream, const Content &cell_content,
                                          const Format &format, size_t text_with_padding_size,
                                          size_t column_width) {
 
     // Apply font style
     apply_element_style(stream, format.font_color_.value(), format.font_background_color_.value(),
                         format.font_style_.value());
-    stream << cell_content;
+    write_content(stream, cell_content);
     // Only apply font_style to the font
     // Not the padding. So calling apply_element_style with font_style = {}
     reset_element_style(stream);
@@ -91,7 +135,8 @@ private:
     }
   }
 
-  static void print_content_center_aligned(std::ostream &stream, const std::string &cell_content,
+  template <typename Content>
+  static void print_content_center_aligned(std::ostream &stream, const Content &cell_content,
                                            const Format &format, size_t text_with_padding_size,
                                            size_t column_width) {
     auto num_spaces = column_width - text_with_padding_size;
@@ -103,7 +148,7 @@ private:
       // Apply font style
       apply_element_style(stream, format.font_color_.value(), format.font_background_color_.value(),
                           format.font_style_.value());
-      stream << cell_content;
+      write_content(stream, cell_content);
       // Only apply font_style to the font
       // Not the padding. So calling apply_element_style with font_style = {}
       reset_element_style(stream);
@@ -120,7 +165,7 @@ private:
       // Apply font style
       apply_element_style(stream, format.font_color_.value(), format.font_background_color_.value(),
                           format.font_style_.value());
-      stream << cell_content;
+      write_content(stream, cell_content);
       // Only apply font_style to the font
       // Not the padding. So calling apply_element_style with font_style = {}
       reset_element_style(stream);
@@ -132,7 +177,8 @@ private:
     }
   }
 
-  static void print_content_right_aligned(std::ostream &stream, const std::string &cell_content,
+  template <typename Content>
+  static void print_content_right_aligned(std::ostream &stream, const Content &cell_content,
                                           const Format &format, size_t text_with_padding_size,
                                           size_t column_width) {
     if (text_with_padding_size < column_width) {
@@ -144,7 +190,7 @@ private:
     // Apply font style
     apply_element_style(stream, format.font_color_.value(), format.font_background_color_.value(),
                         format.font_style_.value());
-    stream << cell_content;
+    write_content(stream, cell_content);
     // Only apply font_style to the font
     // Not the padding. So calling apply_element_style with font_style = {}
     reset_element_style(stream);
@@ -60,8 +60,13 @@ public:
 
   size_t size() const { return cells_.size(); }
 
+  // The formatting set on this row only
   Format &format();
 
+  // Row formatting merged with the table formatting.
+  // Cached until Format::generation() changes.
+  const Format &resolved();
+
   class CellIterator {
   public:
     explicit CellIterator(std::vector<std::shared_ptr<Cell>>::iterator ptr) : ptr(ptr) {}
@@ -91,8 +96,7 @@ private:
   size_t get_configured_height() {
     size_t result{0};
     for (size_t i = 0; i < size(); ++i) {
-      auto cell = cells_[i];
-      auto format = cell->format();
+      const auto &format = cells_[i]->resolved();
       if (format.height_.has_value())
         result = std::max(result, format.height_.value());
     }
@@ -131,52 +135,14 @@ private:
   // ulate
   // .....
   size_t get_cell_height(size_t cell_index, size_t column_width) {
-    size_t result{0};
-    Cell &cell = *(cells_[cell_index]);
-    auto format = cell.format();
-    auto text = cell.get_text();
-
-    auto padding_left = format.padding_left_.value();
-    auto padding_right = format.padding_right_.value();
-
-    result += format.padding_top_.value();
-
-    if (column_width > (padding_left + padding_right)) {
-      column_width -= (padding_left + padding_right);
-    }
-
-    // Check if input text has embedded newline characters
-    auto newlines_in_text = std::count(text.begin(), text.end(), '\n');
-    std::string word_wrapped_text;
-    if (newlines_in_text == 0) {
-      // No new lines in input
-      // Apply automatic word wrapping and compute row height
-      word_wrapped_text = Format::word_wrap(text, column_width, cell.locale(),
-                                            cell.is_multi_byte_character_support_enabled());
-    } else {
-      // There are embedded '\n' characters
-      // Respect these characters
-      word_wrapped_text = text;
-    }
-
-    auto newlines_in_wrapped_text =
-        std::count(word_wrapped_text.begin(), word_wrapped_text.end(), '\n');
-    auto estimated_row_height = newlines_in_wrapped_text;
-
-    if (!word_wrapped_text.empty() &&
-        word_wrapped_text[word_wrapped_text.size() - 1] != '\n') // text doesn't end with a newline
-      estimated_row_height += 1;
-
-    result += estimated_row_height;
-
-    result += format.padding_bottom_.value();
-
-    return result;
+    return cells_[cell_index]->layout(column_width).height;
   }
 
   std::vector<std::shared_ptr<Cell>> cells_;
   std::weak_ptr<class TableInternal> parent_;
   std::optional<Format> format_;
+  Format resolved_;
+  size_t resolved_generation_{0};
 };
 
 } // namespace tabulate
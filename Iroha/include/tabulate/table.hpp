@@ -49,6 +49,7 @@ public:
       cols_ = cells.size();
     }
 
+    // Nested tables are attached to their cells after the row exists
     std::vector<std::string> cell_strings;
     if (cells.size() < cols_) {
       cell_strings.resize(cols_);
@@ -59,18 +60,16 @@ public:
     }
 
     for (size_t i = 0; i < cells.size(); ++i) {
-      auto cell = cells[i];
-      if (std::holds_alternative<std::string>(cell)) {
+      const auto &cell = cells[i];
+      if (std::holds_alternative<std::string>(cell))
         cell_strings[i] = std::get<std::string>(cell);
-      } else {
-        auto table = std::get<Table>(cell);
-        std::stringstream stream;
-        table.print(stream);
-        cell_strings[i] = stream.str();
-      }
     }
 
     table_->add_row(cell_strings);
+    for (size_t i = 0; i < cells.size(); ++i) {
+      if (std::holds_alternative<Table>(cells[i]))
+        (*table_)[table_->size() - 1][i].set_table(std::get<Table>(cells[i]).table_);
+    }
     rows_ += 1;
     return *this;
   }
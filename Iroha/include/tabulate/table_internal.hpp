@@ -32,8 +32,10 @@ SOFTWARE.
 */
 #pragma once
 #include <algorithm>
+#include <cctype>
 #include <iostream>
 #include <string>
+#include <tuple>
 #include <tabulate/column.hpp>
 #include <tabulate/font_style.hpp>
 #include <tabulate/printer.hpp>
@@ -95,7 +97,13 @@ public:
     return result;
   }
 
-  Format &format() { return format_; }
+  Format &format() {
+    Format::touch();
+    return format_;
+  }
+
+  // The table formatting is complete, set_defaults() fills in every field
+  const Format &resolved() const { return format_; }
 
   void print(std::ostream &stream) { Printer::print_table(stream, *this); }
 
@@ -121,33 +129,136 @@ private:
 };
 
 inline Format &Cell::format() {
-  std::shared_ptr<Row> parent = parent_.lock();
-  if (!format_.has_value()) {   // no cell format
-    format_ = parent->format(); // Use parent row format
-  } else {
-    // Cell has formatting
-    // Merge cell formatting with parent row formatting
-    format_ = Format::merge(format_.value(), parent->format());
-  }
+  // The caller may assign to the format instead of using its setters
+  Format::touch();
+  if (!format_.has_value())
+    format_ = Format{};
   return format_.value();
 }
 
+inline const Format &Cell::resolved() {
+  auto generation = Format::generation();
+  if (resolved_generation_ != generation) {
+    std::shared_ptr<Row> parent = parent_.lock();
+    if (!format_.has_value()) // no cell format
+      resolved_ = parent->resolved(); // Use parent row format
+    else
+      // Merge cell formatting with parent row formatting
+      resolved_ = Format::merge(format_.value(), parent->resolved());
+    resolved_generation_ = generation;
+  }
+  return resolved_;
+}
+
 inline bool Cell::is_multi_byte_character_support_enabled() {
-  return format().multi_byte_characters_.value();
+  return resolved().multi_byte_characters_.value();
 }
 
-inline Format &Row::format() {
-  std::shared_ptr<TableInternal> parent = parent_.lock();
-  if (!format_.has_value()) {   // no row format
-    format_ = parent->format(); // Use parent table format
-  } else {
-    // Row has formatting rules
-    // Merge with parent table format
-    format_ = Format::merge(format_.value(), parent->format());
+inline const CellLayout &Cell::layout(size_t column_width) {
+  auto generation = Format::generation();
+  if (layout_generation_ == generation && layout_width_ == column_width)
+    return layout_;
+
+  const auto &format = resolved();
+  layout_.lines.clear();
+
+  if (nested_) {
+    // One line per line of the nested table, printed from its own layout
+    layout_.text.clear();
+    for (const auto &line : table_layout().lines)
+      layout_.lines.push_back({0, 0, line.width});
+    layout_.height =
+        format.padding_top_.value() + layout_.lines.size() + format.padding_bottom_.value();
+    layout_width_ = column_width;
+    layout_generation_ = generation;
+    return layout_;
+  }
+
+  const auto &cell_locale = locale();
+  auto multi_byte = is_multi_byte_character_support_enabled();
+  auto padding_left = format.padding_left_.value();
+  auto padding_right = format.padding_right_.value();
+
+  // Embedded '\n' characters are respected, other text is wrapped to
+  // (column_width - padding_left - padding_right)
+  if (data_.find('\n') != std::string::npos)
+    layout_.text = data_;
+  else if (column_width > padding_left + padding_right)
+    layout_.text =
+        Format::word_wrap(data_, column_width - padding_left - padding_right, cell_locale, multi_byte);
+  else
+    // Configured column width cannot be lower than (padding_left + padding_right)
+    layout_.text.clear();
+
+  // Split into trimmed lines, a trailing '\n' does not start another line
+  const auto &text = layout_.text;
+  auto is_space = [](char c) { return std::isspace(static_cast<unsigned char>(c)) != 0; };
+  for (size_t start = 0; start < text.size();) {
+    auto end = std::min(text.find('\n', start), text.size());
+    auto first = start, last = end;
+    while (first < last && is_space(text[first]))
+      ++first;
+    while (last > first && is_space(text[last - 1]))
+      --last;
+    auto width = get_sequence_length(std::string_view(text).substr(first, last - first),
+                                     cell_locale, multi_byte);
+    layout_.lines.push_back({first, last - first, width});
+    start = end + 1;
+  }
+
+  layout_.height =
+      format.padding_top_.value() + layout_.lines.size() + format.padding_bottom_.value();
+  layout_width_ = column_width;
+  layout_generation_ = generation;
+  return layout_;
+}
+
+inline const TableLayout &Cell::table_layout() {
+  auto generation = Format::generation();
+  if (!nested_layout_ || nested_layout_generation_ != generation) {
+    nested_layout_ = std::make_shared<TableLayout>(Printer::compute_layout(*nested_));
+    nested_layout_generation_ = generation;
   }
+  return *nested_layout_;
+}
+
+inline const std::string &Cell::get_text() {
+  if (!nested_) {
+    return data_;
+  }
+
+  auto generation = Format::generation();
+  if (nested_text_generation_ != generation) {
+    std::stringstream stream;
+    Printer::print_table(stream, *nested_);
+    nested_text_ = stream.str();
+    nested_text_generation_ = generation;
+  }
+  return nested_text_;
+}
+
+inline Format &Row::format() {
+  // The caller may assign to the format instead of using its setters
+  Format::touch();
+  if (!format_.has_value())
+    format_ = Format{};
   return format_.value();
 }
 
+inline const Format &Row::resolved() {
+  auto generation = Format::generation();
+  if (resolved_generation_ != generation) {
+    std::shared_ptr<TableInternal> parent = parent_.lock();
+    if (!format_.has_value()) // no row format
+      resolved_ = parent->resolved(); // Use parent table format
+    else
+      // Merge with parent table format
+      resolved_ = Format::merge(format_.value(), parent->resolved());
+    resolved_generation_ = generation;
+  }
+  return resolved_;
+}
+
 inline std::pair<std::vector<size_t>, std::vector<size_t>>
 Printer::compute_cell_dimensions(TableInternal &table) {
   std::pair<std::vector<size_t>, std::vector<size_t>> result;
@@ -167,7 +278,7 @@ Printer::compute_cell_dimensions(TableInternal &table) {
   }
 
   for (size_t i = 0; i < num_rows; ++i) {
-    Row row = table[i];
+    Row &row = table[i];
     size_t configured_height = row.get_configured_height();
     size_t computed_height = row.get_computed_height(column_widths);
 
@@ -192,61 +303,145 @@ Printer::compute_cell_dimensions(TableInternal &table) {
   return result;
 }
 
-inline void Printer::print_table(std::ostream &stream, TableInternal &table) {
+inline size_t Printer::border_width(TableInternal &table, size_t row,
+                                   const std::vector<size_t> &widths, bool top) {
+  size_t result{0};
+  for (size_t j = 0; j < widths.size(); ++j) {
+    const auto &format = table[row][j].resolved();
+    const auto &corner = top ? format.corner_top_left_.value() : format.corner_bottom_left_.value();
+    const auto &border = top ? format.border_top_.value() : format.border_bottom_.value();
+    auto shown = top ? format.show_border_top_.value() : format.show_border_bottom_.value();
+    if ((corner == "" && border == "") || !shown)
+      continue;
+
+    result += get_sequence_length(corner, "", true) +
+              widths[j] * get_sequence_length(border, "", true);
+    if (j + 1 == widths.size())
+      result += get_sequence_length(
+          top ? format.corner_top_right_.value() : format.corner_bottom_right_.value(), "", true);
+  }
+  return result;
+}
+
+inline TableLayout Printer::compute_layout(TableInternal &table) {
+  TableLayout layout;
   size_t num_rows = table.size();
   size_t num_columns = table.estimate_num_columns();
-  auto dimensions = compute_cell_dimensions(table);
-  auto row_heights = dimensions.first;
-  auto column_widths = dimensions.second;
+  std::tie(layout.row_heights, layout.column_widths) = compute_cell_dimensions(table);
+  const auto &widths = layout.column_widths;
 
-  // For each row,
   for (size_t i = 0; i < num_rows; ++i) {
-
-    // Print top border
-    bool border_top_printed{true};
+    // Top border, on its own line only when every cell of the row has one
+    size_t top_cells{0};
     for (size_t j = 0; j < num_columns; ++j) {
-      border_top_printed &= print_cell_border_top(stream, table, {i, j},
-                                                  {row_heights[i], column_widths[j]}, num_columns);
+      const auto &format = table[i][j].resolved();
+      if ((format.corner_top_left_.value() != "" || format.border_top_.value() != "") &&
+          format.show_border_top_.value())
+        ++top_cells;
     }
-    if (border_top_printed)
-      stream << termcolor::reset << "\n";
+    auto top_width = top_cells ? border_width(table, i, widths, true) : 0;
+    if (top_cells != 0 && top_cells == num_columns)
+      layout.lines.push_back({TableLayout::LineKind::top_border, i, 0, false, false, top_width});
 
-    // Print row contents with word wrapping
-    for (size_t k = 0; k < row_heights[i]; ++k) {
-      for (size_t j = 0; j < num_columns; ++j) {
-        print_row_in_cell(stream, table, {i, j}, {row_heights[i], column_widths[j]}, num_columns,
-                          k);
+    // Row contents
+    size_t content_width{0};
+    for (size_t j = 0; j < num_columns; ++j) {
+      const auto &format = table[i][j].resolved();
+      if (format.show_border_left_.value())
+        content_width += get_sequence_length(format.border_left_.value(), "", true);
+      content_width += widths[j];
+      if (j + 1 == num_columns && format.show_border_right_.value())
+        content_width += get_sequence_length(format.border_right_.value(), "", true);
+    }
+    // Lines with embedded '\n' are not wrapped and may be wider than their column
+    std::vector<size_t> overflow(layout.row_heights[i], 0);
+    for (size_t j = 0; j < num_columns; ++j) {
+      const auto &format = table[i][j].resolved();
+      const auto &cell_layout = table[i][j].layout(widths[j]);
+      auto padding = format.padding_left_.value() + format.padding_right_.value();
+      auto padding_top = format.padding_top_.value();
+      for (size_t m = 0; m < cell_layout.lines.size() && padding_top + m < overflow.size(); ++m) {
+        auto line_width = cell_layout.lines[m].width + padding;
+        if (line_width > widths[j])
+          overflow[padding_top + m] += line_width - widths[j];
       }
-      if (k + 1 < row_heights[i])
-        stream << termcolor::reset << "\n";
     }
 
-    if (i + 1 == num_rows) {
+    auto first_line = layout.lines.size();
+    if (layout.row_heights[i] == 0)
+      layout.lines.push_back({TableLayout::LineKind::blank, i, 0, false, false, 0});
+    for (size_t k = 0; k < layout.row_heights[i]; ++k)
+      layout.lines.push_back(
+          {TableLayout::LineKind::content, i, k, false, false, content_width + overflow[k]});
+    if (top_cells != 0 && top_cells != num_columns) {
+      layout.lines[first_line].top_border_prefix = true;
+      layout.lines[first_line].width += top_width;
+    }
 
-      // Check if there is bottom border to print:
+    if (i + 1 == num_rows && num_columns != 0) {
+      // Bottom border, on its own line unless a cell has neither corner nor border
       auto bottom_border_needed{true};
       for (size_t j = 0; j < num_columns; ++j) {
-        auto cell = table[i][j];
-        auto format = cell.format();
-        auto corner = format.corner_bottom_left_.value();
-        auto border_bottom = format.border_bottom_.value();
-        if (corner == "" && border_bottom == "") {
+        const auto &format = table[i][j].resolved();
+        if (format.corner_bottom_left_.value() == "" && format.border_bottom_.value() == "") {
           bottom_border_needed = false;
           break;
         }
       }
 
-      if (bottom_border_needed)
-        stream << termcolor::reset << "\n";
-      // Print bottom border for table
-      for (size_t j = 0; j < num_columns; ++j) {
-        print_cell_border_bottom(stream, table, {i, j}, {row_heights[i], column_widths[j]},
-                                 num_columns);
+      auto bottom_width = border_width(table, i, widths, false);
+      if (bottom_border_needed) {
+        layout.lines.push_back(
+            {TableLayout::LineKind::bottom_border, i, 0, false, false, bottom_width});
+      } else if (bottom_width != 0) {
+        layout.lines.back().bottom_border_suffix = true;
+        layout.lines.back().width += bottom_width;
       }
     }
-    if (i + 1 < num_rows)
-      stream << termcolor::reset << "\n"; // Don't add newline after last row
   }
+
+  for (const auto &line : layout.lines)
+    layout.width = std::max(layout.width, line.width);
+  return layout;
+}
+
+inline void Printer::print_table(std::ostream &stream, TableInternal &table) {
+  auto layout = compute_layout(table);
+  for (size_t i = 0; i < layout.lines.size(); ++i) {
+    if (i != 0)
+      stream << termcolor::reset << "\n"; // Don't add newline after last line
+    print_table_line(stream, table, layout, i);
+  }
+}
+
+inline void Printer::print_table_line(std::ostream &stream, TableInternal &table,
+                                      const TableLayout &layout, size_t line_index) {
+  const auto &line = layout.lines[line_index];
+  const auto &widths = layout.column_widths;
+  auto num_columns = widths.size();
+  auto height = layout.row_heights[line.row];
+
+  if (line.top_border_prefix || line.kind == TableLayout::LineKind::top_border) {
+    for (size_t j = 0; j < num_columns; ++j)
+      print_cell_border_top(stream, table, {line.row, j}, {height, widths[j]}, num_columns);
+  }
+
+  if (line.kind == TableLayout::LineKind::content) {
+    // Print row contents with word wrapping
+    for (size_t j = 0; j < num_columns; ++j)
+      print_row_in_cell(stream, table, {line.row, j}, {height, widths[j]}, num_columns,
+                        line.row_line);
+  }
+
+  if (line.bottom_border_suffix || line.kind == TableLayout::LineKind::bottom_border) {
+    // Print bottom border for table
+    for (size_t j = 0; j < num_columns; ++j)
+      print_cell_border_bottom(stream, table, {line.row, j}, {height, widths[j]}, num_columns);
+  }
+}
+
+inline void Printer::write_content(std::ostream &stream, const NestedLine &cell_content) {
+  print_table_line(stream, cell_content.table, cell_content.layout, cell_content.index);
 }
 
 inline void Printer::print_row_in_cell(std::ostream &stream, TableInternal &table,
@@ -254,15 +449,10 @@ inline void Printer::print_row_in_cell(std::ostream &stream, TableInternal &tabl
                                        const std::pair<size_t, size_t> &dimension,
                                        size_t num_columns, size_t row_index) {
   auto column_width = dimension.second;
-  auto cell = table[index.first][index.second];
-  auto locale = cell.locale();
-  auto is_multi_byte_character_support_enabled = cell.is_multi_byte_character_support_enabled();
-  std::locale::global(std::locale(locale));
-  auto format = cell.format();
-  auto text = cell.get_text();
-  auto word_wrapped_text =
-      Format::word_wrap(text, column_width, locale, is_multi_byte_character_support_enabled);
-  auto text_height = std::count(word_wrapped_text.begin(), word_wrapped_text.end(), '\n') + 1;
+  auto &cell = table[index.first][index.second];
+  const auto &format = cell.resolved();
+  // Wrapped once per render, the same layout gave the row its height
+  const auto &layout = cell.layout(column_width);
   auto padding_top = format.padding_top_.value();
 
   if (format.show_border_left_.value()) {
@@ -274,77 +464,28 @@ inline void Printer::print_row_in_cell(std::ostream &stream, TableInternal &tabl
 
   apply_element_style(stream, format.font_color_.value(), format.font_background_color_.value(),
                       {});
-  if (row_index < padding_top) {
-    // Padding top
-    stream << std::string(column_width, ' ');
-  } else if (row_index >= padding_top && (row_index <= (padding_top + text_height))) {
-    // // Row contents
-
-    // Retrieve padding left and right
-    // (column_width - padding_left - padding_right) is the amount of space
-    // available for cell text - Use this to word wrap cell contents
+  if (row_index >= padding_top && row_index - padding_top < layout.lines.size()) {
+    // Row contents
+    auto line_index = row_index - padding_top;
     auto padding_left = format.padding_left_.value();
     auto padding_right = format.padding_right_.value();
 
-    // Check if input text has embedded \n that are to be respected
-    auto newlines_in_input = Format::split_lines(text, "\n", cell.locale(),
-                                                 cell.is_multi_byte_character_support_enabled())
-                                 .size() -
-                             1;
-    std::string word_wrapped_text;
-
-    // If there are no embedded \n characters, then apply word wrap
-    if (newlines_in_input == 0) {
-      // Apply word wrapping to input text
-      // Then display one word-wrapped line at a time within cell
-      if (column_width > (padding_left + padding_right))
-        word_wrapped_text =
-            Format::word_wrap(text, column_width - padding_left - padding_right, cell.locale(),
-                              cell.is_multi_byte_character_support_enabled());
-      else {
-        // Configured column width cannot be lower than (padding_left + padding_right)
-        // This is a bad configuration
-        // E.g., the user is trying to force the column width to be 5
-        // when padding_left and padding_right are each configured to 3
-        // (padding_left + padding_right) = 6 > column_width
-      }
-    } else {
-      word_wrapped_text = text; // repect the embedded '\n' characters
-    }
-
-    auto lines = Format::split_lines(word_wrapped_text, "\n", cell.locale(),
-                                     cell.is_multi_byte_character_support_enabled());
-
-    if (row_index - padding_top < lines.size()) {
-      auto line = lines[row_index - padding_top];
-
-      // Print left padding characters
-      stream << std::string(padding_left, ' ');
-
-      // Print word-wrapped line
-      line = Format::trim(line);
-      auto line_with_padding_size =
-          get_sequence_length(line, cell.locale(), cell.is_multi_byte_character_support_enabled()) +
-          padding_left + padding_right;
-      switch (format.font_align_.value()) {
-      case FontAlign::left:
-        print_content_left_aligned(stream, line, format, line_with_padding_size, column_width);
-        break;
-      case FontAlign::center:
-        print_content_center_aligned(stream, line, format, line_with_padding_size, column_width);
-        break;
-      case FontAlign::right:
-        print_content_right_aligned(stream, line, format, line_with_padding_size, column_width);
-        break;
-      }
+    // Print left padding characters
+    stream << std::string(padding_left, ' ');
 
-      // Print right padding characters
-      stream << std::string(padding_right, ' ');
-    } else
-      stream << std::string(column_width, ' ');
+    // Print word-wrapped line, or the line of the nested table
+    auto line_with_padding_size = layout.lines[line_index].width + padding_left + padding_right;
+    if (cell.has_table())
+      print_content(stream, NestedLine{*cell.nested_, cell.table_layout(), line_index}, format,
+                    line_with_padding_size, column_width);
+    else
+      print_content(stream, layout.line(line_index), format, line_with_padding_size,
+                    column_width);
 
+    // Print right padding characters
+    stream << std::string(padding_right, ' ');
   } else {
-    // Padding bottom
+    // Padding top, padding bottom or below the last line
     stream << std::string(column_width, ' ');
   }
 
@@ -365,10 +506,7 @@ inline bool Printer::print_cell_border_top(std::ostream &stream, TableInternal &
                                            const std::pair<size_t, size_t> &index,
                                            const std::pair<size_t, size_t> &dimension,
                                            size_t num_columns) {
-  auto cell = table[index.first][index.second];
-  auto locale = cell.locale();
-  std::locale::global(std::locale(locale));
-  auto format = cell.format();
+  const auto &format = table[index.first][index.second].resolved();
   auto column_width = dimension.second;
 
   auto corner = format.corner_top_left_.value();
@@ -407,10 +545,7 @@ inline bool Printer::print_cell_border_bottom(std::ostream &stream, TableInterna
                                               const std::pair<size_t, size_t> &index,
                                               const std::pair<size_t, size_t> &dimension,
                                               size_t num_columns) {
-  auto cell = table[index.first][index.second];
-  auto locale = cell.locale();
-  std::locale::global(std::locale(locale));
-  auto format = cell.format();
+  const auto &format = table[index.first][index.second].resolved();
   auto column_width = dimension.second;
 
   auto corner = format.corner_bottom_left_.value();
@@ -32,56 +32,191 @@ SOFTWARE.
 */
 #pragma once
 #include <algorithm>
+#include <bitset>
 #include <cstdint>
 #include <string>
+#include <string_view>
 
 #include <clocale>
-#include <locale>
-
 #include <cstdlib>
+#include <map>
+#include <mutex>
 #include <tabulate/termcolor.hpp>
+#include <tabulate/wcwidth.hpp>
 #include <wchar.h>
+#if defined(__APPLE__)
+#include <xlocale.h>
+#endif
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define TABULATE_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TABULATE_SSE2
+#endif
 
 namespace tabulate {
 
+namespace detail {
+
+// Length of the leading run of printable ASCII (0x20 to 0x7E), which is one column per byte.
+// Scans 32 or 16 bytes at a time where AVX2 or SSE2 is available.
+inline size_t printable_ascii_prefix(const char *data, size_t size) {
+  size_t pos = 0;
+#if defined(TABULATE_AVX2)
+  const auto above_space = _mm256_set1_epi8(0x1F);
+  const auto below_delete = _mm256_set1_epi8(0x7F);
+  for (; pos + 32 <= size; pos += 32) {
+    // Bytes of 0x80 and up are negative, so they fail the first comparison
+    auto bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + pos));
+    auto printable = _mm256_and_si256(_mm256_cmpgt_epi8(bytes, above_space),
+                                      _mm256_cmpgt_epi8(below_delete, bytes));
+    auto mask = ~static_cast<uint32_t>(_mm256_movemask_epi8(printable));
+    if (mask != 0)
+      return pos + std::bitset<32>((mask & -mask) - 1).count();
+  }
+#elif defined(TABULATE_SSE2)
+  const auto above_space = _mm_set1_epi8(0x1F);
+  const auto below_delete = _mm_set1_epi8(0x7F);
+  for (; pos + 16 <= size; pos += 16) {
+    // Bytes of 0x80 and up are negative, so they fail the first comparison
+    auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + pos));
+    auto printable =
+        _mm_and_si128(_mm_cmpgt_epi8(bytes, above_space), _mm_cmplt_epi8(bytes, below_delete));
+    auto mask = ~static_cast<uint32_t>(_mm_movemask_epi8(printable)) & 0xFFFF;
+    if (mask != 0)
+      return pos + std::bitset<32>((mask & -mask) - 1).count();
+  }
+#endif
+  while (pos < size && data[pos] >= 0x20 && data[pos] < 0x7F)
+    ++pos;
+  return pos;
+}
+
+// Number of code points, i.e. the bytes that are not UTF-8 continuation bytes (0x80 to 0xBF)
+inline size_t count_code_points(const char *data, size_t size) {
+  size_t result = 0;
+  size_t pos = 0;
+#if defined(TABULATE_AVX2)
+  const auto last_continuation = _mm256_set1_epi8(static_cast<char>(0xBF));
+  for (; pos + 32 <= size; pos += 32) {
+    auto bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + pos));
+    auto leading = _mm256_cmpgt_epi8(bytes, last_continuation);
+    result += std::bitset<32>(static_cast<uint32_t>(_mm256_movemask_epi8(leading))).count();
+  }
+#elif defined(TABULATE_SSE2)
+  const auto last_continuation = _mm_set1_epi8(static_cast<char>(0xBF));
+  for (; pos + 16 <= size; pos += 16) {
+    auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + pos));
+    auto leading = _mm_cmpgt_epi8(bytes, last_continuation);
+    result += std::bitset<32>(static_cast<uint32_t>(_mm_movemask_epi8(leading))).count();
+  }
+#endif
+  for (; pos < size; ++pos)
+    result += (data[pos] & 0xC0) != 0x80;
+  return result;
+}
+
+} // namespace detail
+
+// Decode the UTF-8 sequence at pos and move pos past it.
+// A byte that does not start a valid sequence is returned on its own.
+inline char32_t next_code_point(std::string_view text, size_t &pos) {
+  auto lead = static_cast<unsigned char>(text[pos++]);
+  if (lead < 0x80)
+    return lead;
+
+  size_t length = lead >= 0xF0 ? 3 : lead >= 0xE0 ? 2 : lead >= 0xC0 ? 1 : 0;
+  if (length == 0 || pos + length > text.size())
+    return lead;
+
+  char32_t code_point = lead & (0x3F >> length);
+  for (size_t i = 0; i < length; ++i) {
+    auto byte = static_cast<unsigned char>(text[pos + i]);
+    if ((byte & 0xC0) != 0x80)
+      return lead;
+    code_point = (code_point << 6) | (byte & 0x3F);
+  }
+  pos += length;
+  return code_point;
+}
+
+// Display width of UTF-8 text with the built-in tables, independent of any locale.
+// Like wcswidth(), returns -1 if the text contains a non-printable character.
+inline int get_wcswidth(std::string_view string) {
+  int result = 0;
+  for (size_t pos = 0; pos < string.size();) {
+    // Runs of plain ASCII are counted in bulk, only the other characters are looked up
+    auto run = detail::printable_ascii_prefix(string.data() + pos, string.size() - pos);
+    result += static_cast<int>(run);
+    pos += run;
+    if (pos == string.size())
+      break;
+
+    auto width = code_point_width(next_code_point(string, pos));
+    if (width < 0)
+      return -1;
+    result += width;
+  }
+  return result;
+}
+
 #if defined(__unix__) || defined(__unix) || defined(__APPLE__)
-inline int get_wcswidth(const std::string &string, const std::string &locale,
+// Display width according to the LC_CTYPE of the named locale, for cells that ask for one.
+// The locale is only installed for the calling thread while measuring.
+inline int get_wcswidth(std::string_view string, const std::string &locale,
                         size_t max_column_width) {
   if (string.size() == 0)
     return 0;
 
-  // The behavior of wcswidth() depends on the LC_CTYPE category of the current locale.
-  // Set the current locale based on cell properties before computing width
-  std::locale::global(std::locale(locale));
+  // Locales are created once per name and kept for the lifetime of the program
+  static std::mutex mutex;
+  static std::map<std::string, locale_t> locales;
+  locale_t ctype;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = locales.find(locale);
+    if (it == locales.end())
+      it = locales.emplace(locale, newlocale(LC_CTYPE_MASK, locale.c_str(), locale_t(0))).first;
+    ctype = it->second;
+  }
+  if (ctype == locale_t(0))
+    return -1;
+
+  auto previous = uselocale(ctype);
 
   // Convert from narrow std::string to wide string
-  wchar_t *wide_string = new wchar_t[string.size()];
-  std::mbstowcs(wide_string, string.c_str(), string.size());
+  std::wstring wide_string(string.size(), L'\0');
+  auto converted = std::mbstowcs(&wide_string[0], std::string(string).c_str(), wide_string.size());
 
   // Compute display width of wide string
-  int result = wcswidth(wide_string, max_column_width);
-  delete[] wide_string;
+  int result = converted == static_cast<size_t>(-1)
+                   ? -1
+                   : wcswidth(wide_string.c_str(), std::min(converted, max_column_width));
+  uselocale(previous);
 
   return result;
 }
 #endif
 
-inline size_t get_sequence_length(const std::string &text, const std::string &locale,
+inline size_t get_sequence_length(std::string_view text, const std::string &locale,
                                   bool is_multi_byte_character_support_enabled) {
   if (!is_multi_byte_character_support_enabled)
     return text.length();
 
-#if defined(_WIN32) || defined(_WIN64)
-  return (text.length() - std::count_if(text.begin(), text.end(),
-                                        [](char c) -> bool { return (c & 0xC0) == 0x80; }));
-#elif defined(__unix__) || defined(__unix) || defined(__APPLE__)
-  auto result = get_wcswidth(text, locale, text.size());
-  if (result >= 0)
-    return result;
+  int result = -1;
+#if defined(__unix__) || defined(__unix) || defined(__APPLE__)
+  if (!locale.empty())
+    result = get_wcswidth(text, locale, text.size());
   else
-    return (text.length() - std::count_if(text.begin(), text.end(),
-                                          [](char c) -> bool { return (c & 0xC0) == 0x80; }));
 #endif
+    result = get_wcswidth(text);
+
+  if (result >= 0)
+    return result;
+
+  // Non-printable characters, count the code points instead
+  return detail::count_code_points(text.data(), text.size());
 }
 
 } // namespace tabulate
\ No newline at end of file